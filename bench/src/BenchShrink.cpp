@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+// Benchmarks the runner and the shrinker end to end. Passing properties
+// report checked tests per second. Failing properties, with known minimal
+// counterexamples, report per failing run the number of checked shrink
+// candidates, the accepted shrinks, the length of the printed
+// counterexample and how often the minimal counterexample was found.
+// Each benchmark runs with the seeds 0..runs-1, so the numbers are
+// reproducible and can be compared between changes to the shrinker.
+//
+// Usage: cppqc-bench-shrink [--format=csv|json] [--runs=N]
+//                           [--filter=SUBSTRING]
+
+namespace {
+
+// The properties of the examples TestSort, TestReverse and
+// TestSlowShrinking, without their output and artificial delays.
+
+template <typename InputIterator>
+void selectionSort(InputIterator b, InputIterator e, bool makeMistakes)
+{
+    makeMistakes && b != e ? ++b : b;
+    for (InputIterator c = b; c != e; ++c)
+        std::swap(*(std::min_element(c, e)), *c);
+}
+
+struct PropTestSort : cppqc::Property<std::vector<int>>
+{
+    explicit PropTestSort(bool makeMistakes) : makeMistakes(makeMistakes) {}
+
+    bool check(const std::vector<int> &v) const override
+    {
+        std::vector<int> copy(v);
+        selectionSort(copy.begin(), copy.end(), makeMistakes);
+        return std::is_sorted(copy.begin(), copy.end());
+    }
+
+    const bool makeMistakes;
+};
+
+struct PropTestReverse : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        std::vector<int> vrev(v);
+        std::reverse(vrev.begin(), vrev.end());
+        std::reverse(vrev.begin(), vrev.end());
+        return std::equal(v.begin(), v.end(), vrev.begin());
+    }
+};
+
+struct PropTestSlowFunction : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        return !(v.size() >= 4 && (v[3] % 5) == 1);
+    }
+};
+
+// Synthetic failures
+
+struct PropMaxBelow50 : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        return std::all_of(v.begin(), v.end(),
+                           [](int x) { return x < 50; });
+    }
+};
+
+struct PropShorterThan10 : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        return v.size() < 10;
+    }
+};
+
+struct PropNoDuplicates : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        return std::set<int>(v.begin(), v.end()).size() == v.size();
+    }
+};
+
+struct PropSumBelow100 : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        long sum = 0;
+        for (int x : v)
+            sum += std::abs(x);
+        return sum < 100;
+    }
+};
+
+struct PropIntBelow12345 : cppqc::Property<int>
+{
+    PropIntBelow12345() : Property(cppqc::choose(0, 100000)) {}
+
+    bool check(const int &x) const override
+    {
+        return x < 12345;
+    }
+};
+
+struct PropOrderedPair : cppqc::Property<int, int>
+{
+    bool check(const int &a, const int &b) const override
+    {
+        return a < b;
+    }
+};
+
+// Keeps the shrunk counterexample of a failing run.
+template<class Input>
+struct CapturingReporter : cppqc::NullReporter
+{
+    void failed(const cppqc::PropertyBase &, std::size_t, std::size_t,
+                const Input &in, const cppqc::TestCaseId &)
+    {
+        counterexample = in;
+    }
+
+    Input counterexample;
+};
+
+struct Record
+{
+    std::string name;
+    std::size_t runs;
+    std::size_t failures;
+    double testsPerSecond; // passing runs only
+    double shrinkEvaluations; // means over the failing runs
+    double acceptedShrinks;
+    double counterexampleChars;
+    double minimalRate;
+    double seconds;
+};
+
+struct Benchmark
+{
+    std::string name;
+    std::function<Record (std::size_t runs)> run;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+template<class Prop>
+Benchmark passing(const std::string &name, Prop prop)
+{
+    return Benchmark{name, [=](std::size_t runs) {
+        Record r = { name, runs, 0, 0, 0, 0, 0, 0, 0 };
+        std::size_t tests = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t seed = 0; seed < runs; ++seed) {
+            cppqc::NullReporter reporter;
+            const cppqc::Result result = cppqc::quickCheckReport(prop,
+                reporter, 1000, 0, 0, cppqc::DISABLE_SHRINK_TIMEOUT,
+                cppqc::SeedType(seed));
+            tests += result.numTests;
+            if (result.result != cppqc::QC_SUCCESS)
+                ++r.failures;
+        }
+        r.seconds = secondsSince(start);
+        r.testsPerSecond = tests / r.seconds;
+        return r;
+    }};
+}
+
+template<class Prop>
+Benchmark failing(const std::string &name, Prop prop,
+                  const typename Prop::Input &minimal)
+{
+    return Benchmark{name, [=](std::size_t runs) {
+        typedef typename Prop::Input Input;
+        Record r = { name, runs, 0, 0, 0, 0, 0, 0, 0 };
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t seed = 0; seed < runs; ++seed) {
+            CapturingReporter<Input> reporter;
+            const cppqc::Result result = cppqc::quickCheckReport(prop,
+                reporter, 100, 0, 0, cppqc::DISABLE_SHRINK_TIMEOUT,
+                cppqc::SeedType(seed));
+            if (result.result != cppqc::QC_FAILURE)
+                continue;
+            ++r.failures;
+            r.shrinkEvaluations += result.numShrinkEvaluations;
+            r.acceptedShrinks += result.numShrinks;
+            std::ostringstream printed;
+            cppqc::printInput(printed, reporter.counterexample);
+            r.counterexampleChars += printed.str().size();
+            if (reporter.counterexample == minimal)
+                r.minimalRate += 1;
+        }
+        r.seconds = secondsSince(start);
+        if (r.failures != 0) {
+            r.shrinkEvaluations /= r.failures;
+            r.acceptedShrinks /= r.failures;
+            r.counterexampleChars /= r.failures;
+            r.minimalRate /= r.failures;
+        }
+        return r;
+    }};
+}
+
+std::vector<Benchmark> benchmarks()
+{
+    using std::make_tuple;
+    typedef std::vector<int> V;
+    return {
+        passing("TestSort (correct)", PropTestSort(false)),
+        passing("TestReverse", PropTestReverse()),
+        failing("TestSort", PropTestSort(true), make_tuple(V{1, 0})),
+        failing("TestSlowShrinking", PropTestSlowFunction(),
+                make_tuple(V{0, 0, 0, 1})),
+        failing("max below 50", PropMaxBelow50(), make_tuple(V{50})),
+        failing("shorter than 10", PropShorterThan10(),
+                make_tuple(V(10, 0))),
+        failing("no duplicates", PropNoDuplicates(), make_tuple(V{0, 0})),
+        failing("sum below 100", PropSumBelow100(), make_tuple(V{100})),
+        failing("int below 12345", PropIntBelow12345(), make_tuple(12345)),
+        failing("ordered pair", PropOrderedPair(), make_tuple(0, 0)),
+    };
+}
+
+bool startsWith(const char *arg, const char *prefix, const char *&value)
+{
+    const std::size_t n = std::strlen(prefix);
+    if (std::strncmp(arg, prefix, n) != 0)
+        return false;
+    value = arg + n;
+    return true;
+}
+
+int usage(const char *name)
+{
+    std::cerr << "Usage: " << name << " [--format=csv|json] [--runs=N]"
+              << " [--filter=SUBSTRING]\n";
+    return 2;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    bool json = false;
+    std::size_t runs = 20;
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *value = nullptr;
+        if (startsWith(argv[i], "--format=", value)) {
+            if (std::strcmp(value, "json") == 0)
+                json = true;
+            else if (std::strcmp(value, "csv") != 0)
+                return usage(argv[0]);
+        } else if (startsWith(argv[i], "--runs=", value)) {
+            runs = std::strtoul(value, nullptr, 10);
+        } else if (startsWith(argv[i], "--filter=", value)) {
+            filter = value;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    std::cout << std::setprecision(6);
+    if (json)
+        std::cout << "[\n";
+    else
+        std::cout << "benchmark,runs,failures,tests_per_second,"
+                     "shrink_evaluations,accepted_shrinks,"
+                     "counterexample_chars,minimal_rate,seconds\n";
+
+    const char *sep = "";
+    for (const Benchmark &bench : benchmarks()) {
+        if (bench.name.find(filter) == std::string::npos)
+            continue;
+        const Record r = bench.run(runs);
+        if (json) {
+            std::cout << sep << "  {\"benchmark\": \"" << r.name
+                      << "\", \"runs\": " << r.runs
+                      << ", \"failures\": " << r.failures
+                      << ", \"tests_per_second\": " << r.testsPerSecond
+                      << ", \"shrink_evaluations\": " << r.shrinkEvaluations
+                      << ", \"accepted_shrinks\": " << r.acceptedShrinks
+                      << ", \"counterexample_chars\": "
+                      << r.counterexampleChars
+                      << ", \"minimal_rate\": " << r.minimalRate
+                      << ", \"seconds\": " << r.seconds << '}';
+            sep = ",\n";
+        } else {
+            std::cout << '"' << r.name << "\"," << r.runs << ','
+                      << r.failures << ',' << r.testsPerSecond << ','
+                      << r.shrinkEvaluations << ',' << r.acceptedShrinks
+                      << ',' << r.counterexampleChars << ','
+                      << r.minimalRate << ',' << r.seconds << '\n';
+        }
+    }
+    if (json)
+        std::cout << "\n]\n";
+}
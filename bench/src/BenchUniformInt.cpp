@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+
+#include <boost/random/uniform_int.hpp>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// Compares the per-draw cost of the precomputed Lemire sampler used by
+// choose/elements/oneof with the distributions that were constructed on
+// every call before.
+
+namespace {
+
+const std::size_t NUM_DRAWS = 20000000;
+
+template<class F>
+double nanosecondsPerDraw(F draw)
+{
+    cppqc::RngEngine rng(42);
+    std::uint64_t sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < NUM_DRAWS; ++i)
+        sink += draw(rng);
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    // keep the compiler from discarding the loop
+    volatile std::uint64_t keep = sink;
+    (void) keep;
+    return elapsed.count() / NUM_DRAWS;
+}
+
+template<class Integer>
+void benchRange(const char *name, Integer min, Integer max)
+{
+    const double boostPerCall = nanosecondsPerDraw([=](cppqc::RngEngine &rng) {
+        boost::uniform_int<Integer> dist(min, max);
+        return dist(rng);
+    });
+    const double stdPerCall = nanosecondsPerDraw([=](cppqc::RngEngine &rng) {
+        std::uniform_int_distribution<Integer> dist(min, max);
+        return dist(rng);
+    });
+    const double perCall = nanosecondsPerDraw([=](cppqc::RngEngine &rng) {
+        return cppqc::detail::uniformInt<Integer>(rng, min, max);
+    });
+    const cppqc::detail::UniformIntSampler<Integer> sampler(min, max);
+    const double precomputed = nanosecondsPerDraw([&](cppqc::RngEngine &rng) {
+        return sampler(rng);
+    });
+
+    std::cout << std::left << std::setw(14) << name << std::right
+              << std::fixed << std::setprecision(2)
+              << std::setw(14) << boostPerCall
+              << std::setw(14) << stdPerCall
+              << std::setw(14) << perCall
+              << std::setw(14) << precomputed << '\n';
+}
+
+}
+
+int main()
+{
+    std::cout << "ns per draw (" << NUM_DRAWS << " draws each)\n"
+              << std::left << std::setw(14) << "range" << std::right
+              << std::setw(14) << "boost"
+              << std::setw(14) << "std"
+              << std::setw(14) << "lemire/call"
+              << std::setw(14) << "lemire/pre" << '\n';
+
+    benchRange<int>("[0, 1]", 0, 1);
+    benchRange<int>("[2, 1000]", 2, 1000);
+    benchRange<std::size_t>("[0, 6]", 0, 6);
+    benchRange<std::uint32_t>("[0, 2^31]", 0, 0x80000000u);
+    benchRange<std::int64_t>("[-2^40, 2^40]", -(std::int64_t(1) << 40),
+                             std::int64_t(1) << 40);
+    benchRange<std::uint64_t>("[0, 2^64-1]", 0,
+                              std::numeric_limits<std::uint64_t>::max());
+}
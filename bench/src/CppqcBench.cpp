@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Measures the throughput of the built-in generators and combinators in
+// values and bytes per second for several size parameters. The output is
+// CSV (default) or JSON, one record per generator and size, so that runs
+// of different commits can be compared with standard tools.
+//
+// Usage: cppqc-bench [--format=csv|json] [--min-time=SECONDS]
+//                    [--sizes=S1,S2,...] [--filter=SUBSTRING]
+
+namespace {
+
+// Approximate number of bytes of a generated value, including the
+// elements of containers.
+template<class T>
+std::size_t payloadBytes(const T &)
+{
+    return sizeof(T);
+}
+
+template<class CharT, class Traits, class Alloc>
+std::size_t payloadBytes(const std::basic_string<CharT, Traits, Alloc> &s)
+{
+    return sizeof(s) + s.size() * sizeof(CharT);
+}
+
+template<class T>
+std::size_t payloadBytes(const std::vector<T> &v)
+{
+    std::size_t bytes = sizeof(v);
+    for (const T &x : v)
+        bytes += payloadBytes(x);
+    return bytes;
+}
+
+template<class T, std::size_t N>
+std::size_t payloadBytes(const std::array<T, N> &a)
+{
+    std::size_t bytes = 0;
+    for (const T &x : a)
+        bytes += payloadBytes(x);
+    return bytes;
+}
+
+template<class T1, class T2>
+std::size_t payloadBytes(const std::pair<T1, T2> &p)
+{
+    return payloadBytes(p.first) + payloadBytes(p.second);
+}
+
+template<class... T, std::size_t... I>
+std::size_t tuplePayloadBytes(const std::tuple<T...> &t,
+                              cppqc::detail::IndexList<I...>)
+{
+    std::size_t bytes = 0;
+    const int expand[] = { 0, (bytes += payloadBytes(std::get<I>(t)), 0)... };
+    (void) expand;
+    return bytes;
+}
+
+template<class... T>
+std::size_t payloadBytes(const std::tuple<T...> &t)
+{
+    return tuplePayloadBytes(t,
+        typename cppqc::detail::MakeIndexList<sizeof...(T)>::type());
+}
+
+struct Measurement
+{
+    std::size_t values;
+    std::size_t discarded; // rejected by suchThat, as in the runner
+    std::size_t bytes;
+    double seconds;
+};
+
+typedef std::function<Measurement (std::size_t, double)> BenchFunction;
+
+// Generates one value and returns its size, or 0 if it was rejected.
+template<class T>
+std::size_t generateOne(cppqc::Generator<T> &gen, cppqc::RngEngine &rng,
+                        std::size_t size)
+{
+    try {
+        return payloadBytes(gen.unGen(rng, size));
+    } catch (...) {
+        return 0;
+    }
+}
+
+// Generates values in growing batches until minSeconds have passed.
+template<class T>
+BenchFunction benchGenerator(cppqc::Generator<T> gen)
+{
+    return [gen](std::size_t size, double minSeconds) mutable {
+        cppqc::RngEngine rng(42);
+        Measurement m = { 0, 0, 0, 0.0 };
+        for (int i = 0; i < 10; ++i)
+            generateOne(gen, rng, size);
+
+        const auto start = std::chrono::steady_clock::now();
+        for (std::size_t batch = 16; m.seconds < minSeconds; batch *= 2) {
+            for (std::size_t i = 0; i < batch; ++i) {
+                const std::size_t bytes = generateOne(gen, rng, size);
+                if (bytes == 0) {
+                    ++m.discarded;
+                } else {
+                    m.bytes += bytes;
+                    ++m.values;
+                }
+            }
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - start;
+            m.seconds = elapsed.count();
+        }
+        return m;
+    };
+}
+
+std::vector<std::pair<std::string, BenchFunction>> benchmarks()
+{
+    using namespace cppqc;
+    std::vector<std::pair<std::string, BenchFunction>> b;
+
+    b.emplace_back("arbitrary<bool>", benchGenerator<bool>(Arbitrary<bool>()));
+    b.emplace_back("arbitrary<int>", benchGenerator<int>(Arbitrary<int>()));
+    b.emplace_back("arbitrary<unsigned long>",
+        benchGenerator<unsigned long>(Arbitrary<unsigned long>()));
+    b.emplace_back("arbitrary<char>", benchGenerator<char>(Arbitrary<char>()));
+    b.emplace_back("arbitrary<float>",
+        benchGenerator<float>(Arbitrary<float>()));
+    b.emplace_back("arbitrary<double>",
+        benchGenerator<double>(Arbitrary<double>()));
+    b.emplace_back("arbitrary<std::string>",
+        benchGenerator<std::string>(Arbitrary<std::string>()));
+    b.emplace_back("arbitrary<std::wstring>",
+        benchGenerator<std::wstring>(Arbitrary<std::wstring>()));
+
+    b.emplace_back("choose", benchGenerator<int>(choose(-1000, 1000)));
+    b.emplace_back("elements", benchGenerator<int>(
+        elements({1, 2, 3, 5, 8, 13, 21, 34})));
+    b.emplace_back("oneof", benchGenerator<int>(
+        oneof<int>(choose(0, 10))(choose(100, 110))(Arbitrary<int>())));
+    b.emplace_back("frequency", benchGenerator<int>(
+        frequency<int>(1, choose(0, 10))(3, choose(100, 110))
+            (6, Arbitrary<int>())));
+    b.emplace_back("suchThat", benchGenerator<int>(
+        suchThat(choose(0, 1000), [](int x) { return x % 2 == 0; })));
+    b.emplace_back("resize", benchGenerator<std::vector<int>>(
+        resize(10, listOf<int>())));
+
+    b.emplace_back("listOf<int>",
+        benchGenerator<std::vector<int>>(listOf<int>()));
+    b.emplace_back("listOfNonEmpty<int>",
+        benchGenerator<std::vector<int>>(listOfNonEmpty<int>()));
+    b.emplace_back("listOf<std::string>",
+        benchGenerator<std::vector<std::string>>(listOf<std::string>()));
+    b.emplace_back("arrayOf<int, 16>",
+        benchGenerator<std::array<int, 16>>(arrayOf<int, 16>()));
+    b.emplace_back("tupleOf<int, double, bool>",
+        benchGenerator<std::tuple<int, double, bool>>(
+            tupleOf<int, double, bool>()));
+    b.emplace_back("pair<int, std::string>",
+        benchGenerator<std::pair<int, std::string>>(
+            Arbitrary<std::pair<int, std::string>>()));
+
+    b.emplace_back("convert", benchGenerator<long>(convert<long, int>(
+        [](int x) { return 2L * x; })));
+    b.emplace_back("combine", benchGenerator<long>(combine<long, int, int>(
+        [](int x, int y) { return long(x) * y; })));
+
+    return b;
+}
+
+bool startsWith(const char *arg, const char *prefix, const char *&value)
+{
+    const std::size_t n = std::strlen(prefix);
+    if (std::strncmp(arg, prefix, n) != 0)
+        return false;
+    value = arg + n;
+    return true;
+}
+
+int usage(const char *name)
+{
+    std::cerr << "Usage: " << name << " [--format=csv|json]"
+              << " [--min-time=SECONDS] [--sizes=S1,S2,...]"
+              << " [--filter=SUBSTRING]\n";
+    return 2;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+    bool json = false;
+    double minSeconds = 0.1;
+    std::vector<std::size_t> sizes = {0, 10, 100, 1000};
+    std::string filter;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *value = nullptr;
+        if (startsWith(argv[i], "--format=", value)) {
+            if (std::strcmp(value, "json") == 0)
+                json = true;
+            else if (std::strcmp(value, "csv") != 0)
+                return usage(argv[0]);
+        } else if (startsWith(argv[i], "--min-time=", value)) {
+            minSeconds = std::atof(value);
+            // the rates divide by the measured time
+            if (!(minSeconds > 0))
+                return usage(argv[0]);
+        } else if (startsWith(argv[i], "--sizes=", value)) {
+            sizes.clear();
+            std::istringstream in(value);
+            std::string size;
+            while (std::getline(in, size, ','))
+                sizes.push_back(std::strtoul(size.c_str(), nullptr, 10));
+        } else if (startsWith(argv[i], "--filter=", value)) {
+            filter = value;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    std::cout << std::setprecision(6);
+    if (json)
+        std::cout << "[\n";
+    else
+        std::cout << "generator,size,values,discarded,seconds,"
+                     "values_per_second,bytes_per_second\n";
+
+    const char *sep = "";
+    for (auto &bench : benchmarks()) {
+        if (bench.first.find(filter) == std::string::npos)
+            continue;
+        for (std::size_t size : sizes) {
+            const Measurement m = bench.second(size, minSeconds);
+            const double valuesPerSecond = m.values / m.seconds;
+            const double bytesPerSecond = m.bytes / m.seconds;
+            if (json) {
+                std::cout << sep << "  {\"generator\": \"" << bench.first
+                          << "\", \"size\": " << size
+                          << ", \"values\": " << m.values
+                          << ", \"discarded\": " << m.discarded
+                          << ", \"seconds\": " << m.seconds
+                          << ", \"values_per_second\": " << valuesPerSecond
+                          << ", \"bytes_per_second\": " << bytesPerSecond
+                          << '}';
+                sep = ",\n";
+            } else {
+                std::cout << '"' << bench.first << "\"," << size << ','
+                          << m.values << ',' << m.discarded << ','
+                          << m.seconds << ','
+                          << valuesPerSecond << ',' << bytesPerSecond << '\n';
+            }
+        }
+    }
+    if (json)
+        std::cout << "\n]\n";
+}
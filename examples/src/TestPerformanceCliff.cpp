@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Performance.h"
+
+#include <vector>
+
+// A hash set with open addressing and a weak hash function. Keys that are
+// equal modulo the capacity all land in the same probe sequence, which
+// makes insertion quadratic.
+class WeakHashSet
+{
+    public:
+        WeakHashSet() : m_slots(CAPACITY), m_used(CAPACITY, false)
+        {
+        }
+
+        void insert(int key)
+        {
+            std::size_t i = static_cast<unsigned>(key) % CAPACITY;
+            for (std::size_t probes = 0; probes < CAPACITY; ++probes) {
+                if (!m_used[i]) {
+                    m_used[i] = true;
+                    m_slots[i] = key;
+                    return;
+                }
+                if (m_slots[i] == key)
+                    return;
+                i = (i + 1) % CAPACITY;
+            }
+        }
+
+    private:
+        static const std::size_t CAPACITY = 4096;
+        std::vector<int> m_slots;
+        std::vector<bool> m_used;
+};
+
+// Searches for inputs whose insertion takes more than 20 microseconds,
+// and shrinks them to a small reproducer of the collision cliff.
+struct PropInsertIsFast : cppqc::PerformanceProperty<std::vector<int>>
+{
+    PropInsertIsFast() : PerformanceProperty(20000.0,
+        cppqc::listOf<int>(cppqc::convert<int, int>(
+            [](int x) { return x * 4096; }, cppqc::choose(0, 5000))))
+    {
+    }
+
+    double cost(const std::vector<int> &keys) const override
+    {
+        return cppqc::measureNanoseconds([&] {
+            WeakHashSet set;
+            for (int key : keys)
+                set.insert(key);
+        });
+    }
+
+    std::string name() const override
+    {
+        return "Inserting into the hash set is fast";
+    }
+};
+
+int main()
+{
+    cppqc::quickCheckPerformance(PropInsertIsFast(), std::cout, 100, 0, 400);
+}
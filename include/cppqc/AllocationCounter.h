@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_ALLOCATION_COUNTER_H
+#define CPPQC_ALLOCATION_COUNTER_H
+
+#include <algorithm>
+#include <cstddef>
+
+// Allocation counting is opt-in: link against the "cppqc-alloc" library,
+// which replaces the global operator new and delete with versions that
+// count allocations per thread.
+//
+// While the library is linked, the runner reports the number of
+// allocations and allocated bytes of each check next to the labels.
+// Inside a property, use AllocationCounter to assert on the allocations
+// of the code under test, for instance:
+//
+//     bool check(const std::vector<int> &v) const override
+//     {
+//         cppqc::AllocationCounter counter;
+//         hotPath(v);
+//         return counter.allocations() == 0;
+//     }
+//
+// The runner also reports the peak heap bytes of each check and the bytes
+// it retained after returning; see Memory.h for leak detection.
+//
+// Only allocations through operator new are counted, not direct calls to
+// malloc. Memory released on another thread than it was allocated on is
+// counted as freed by the releasing thread.
+
+namespace cppqc {
+
+struct AllocationCounts
+{
+    std::size_t allocations;
+    std::size_t deallocations;
+    std::size_t bytesAllocated;
+    std::size_t bytesFreed;
+};
+
+/// Returns the counters of the calling thread since it was started.
+AllocationCounts threadAllocationCounts();
+
+/// Returns the bytes allocated minus the bytes freed by the calling thread.
+std::ptrdiff_t threadLiveBytes();
+
+/// Returns the highest value threadLiveBytes has reached since the last
+/// call of exchangeThreadPeakLiveBytes.
+std::ptrdiff_t threadPeakLiveBytes();
+
+/// Replaces the peak of threadLiveBytes and returns the previous one.
+/// Nested measurements reset the peak to the current live bytes when they
+/// start and restore the maximum of both peaks when they end.
+std::ptrdiff_t exchangeThreadPeakLiveBytes(std::ptrdiff_t peak);
+
+/// Allocations of the calling thread while an object of this class lives
+/// are not counted, and neither are their deallocations later on. Meant
+/// for bookkeeping of the test harness that must not look like a leak of
+/// the code under test.
+class UncountedAllocations
+{
+    public:
+        UncountedAllocations();
+        ~UncountedAllocations();
+
+    private:
+        UncountedAllocations(const UncountedAllocations &);
+        UncountedAllocations &operator=(const UncountedAllocations &);
+};
+
+/// Counts the allocations of the calling thread during its lifetime.
+class AllocationCounter
+{
+    public:
+        AllocationCounter() :
+            m_start(threadAllocationCounts()),
+            m_startLive(threadLiveBytes()),
+            m_outerPeak(exchangeThreadPeakLiveBytes(m_startLive))
+        {
+        }
+
+        ~AllocationCounter()
+        {
+            exchangeThreadPeakLiveBytes(
+                std::max(m_outerPeak, threadPeakLiveBytes()));
+        }
+
+        std::size_t allocations() const
+        {
+            return threadAllocationCounts().allocations - m_start.allocations;
+        }
+
+        std::size_t deallocations() const
+        {
+            return threadAllocationCounts().deallocations -
+                   m_start.deallocations;
+        }
+
+        std::size_t bytesAllocated() const
+        {
+            return threadAllocationCounts().bytesAllocated -
+                   m_start.bytesAllocated;
+        }
+
+        std::size_t bytesFreed() const
+        {
+            return threadAllocationCounts().bytesFreed - m_start.bytesFreed;
+        }
+
+        /// Highest number of bytes held in addition to those held at
+        /// construction.
+        std::ptrdiff_t peakBytes() const
+        {
+            return threadPeakLiveBytes() - m_startLive;
+        }
+
+        /// Bytes held now in addition to those held at construction.
+        std::ptrdiff_t retainedBytes() const
+        {
+            return threadLiveBytes() - m_startLive;
+        }
+
+    private:
+        AllocationCounter(const AllocationCounter &);
+        AllocationCounter &operator=(const AllocationCounter &);
+
+        const AllocationCounts m_start;
+        const std::ptrdiff_t m_startLive;
+        const std::ptrdiff_t m_outerPeak;
+};
+
+}
+
+#endif
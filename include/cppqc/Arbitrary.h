@@ -28,10 +28,11 @@
 
 #include "Generator.h"
 
+#include <algorithm>
 #include <limits>
+#include <type_traits>
 
-#include <boost/random/uniform_int.hpp>
-#include <boost/random/uniform_smallint.hpp>
+#include <boost/math/distributions/poisson.hpp>
 #include <boost/random/uniform_real.hpp>
 #include <boost/random/uniform_01.hpp>
 #include <boost/random/poisson_distribution.hpp>
@@ -44,20 +45,23 @@ namespace cppqc {
 template<class Integral>
 Integral arbitrarySizedIntegral(RngEngine &rng, std::size_t size)
 {
-    boost::uniform_int<Integral> dist(std::numeric_limits<Integral>::is_signed ?
+    return detail::uniformInt<Integral>(rng,
+            std::numeric_limits<Integral>::is_signed ?
             -Integral(size) : Integral(size),
             Integral(size));
-    return dist(rng);
 }
 
 template<class Integral>
 Integral arbitraryBoundedIntegral(RngEngine &rng, std::size_t /*size*/)
 {
-    boost::uniform_int<Integral> dist(std::numeric_limits<Integral>::min(),
+    constexpr detail::UniformIntSampler<Integral> dist(
+            std::numeric_limits<Integral>::min(),
             std::numeric_limits<Integral>::max());
     return dist(rng);
 }
 
+// Poisson distributed around size, with edge cases of the whole type mixed
+// in (see edgeCasePercent).
 template<class Integral>
 Integral arbitrarySizedBoundedIntegral(RngEngine &rng, std::size_t size)
 {
@@ -65,12 +69,36 @@ Integral arbitrarySizedBoundedIntegral(RngEngine &rng, std::size_t size)
     boost::variate_generator<RngEngine&, boost::uniform_01<> > gen(rng, boost::uniform_01<>());
     Integral r = dist(gen);
     if (std::numeric_limits<Integral>::is_signed) {
-        if (boost::uniform_smallint<int>(0, 1)(rng))
+        constexpr detail::UniformIntSampler<int> coin(0, 1);
+        if (coin(rng))
             r = -r;
     }
+    if (detail::drawEdgeCase(rng)) {
+        return detail::edgeCase(rng, std::numeric_limits<Integral>::min(),
+                                std::numeric_limits<Integral>::max());
+    }
     return r;
 }
 
+// the quantile u of arbitrarySizedBoundedIntegral without its edge cases
+// (see quantile in Generator.h): the Poisson distributed magnitude, negated
+// in the lower half if the type is signed
+template<class Integral>
+Integral arbitrarySizedIntegralQuantile(double u, std::size_t size)
+{
+    typedef std::numeric_limits<Integral> Limits;
+    double p = u;
+    if (Limits::is_signed)
+        p = u < 0.5 ? 1 - 2 * u : 2 * u - 1;
+    // below 1, where the quantile is finite
+    p = std::min(p, 1 - std::numeric_limits<double>::epsilon() / 2);
+    const boost::math::poisson_distribution<double> dist(
+        size == 0 ? 1.0 : double(size));
+    const Integral r = Integral(std::min(boost::math::quantile(dist, p),
+                                         double(Limits::max())));
+    return Limits::is_signed && u < 0.5 ? Integral(-r) : r;
+}
+
 template<class Real>
 Real arbitrarySizedReal(RngEngine &rng, std::size_t size)
 {
@@ -78,6 +106,14 @@ Real arbitrarySizedReal(RngEngine &rng, std::size_t size)
     return dist(rng);
 }
 
+// the quantile u of arbitrarySizedReal (see quantile in Generator.h)
+template<class Real>
+Real arbitrarySizedRealQuantile(double u, std::size_t size)
+{
+    const Real bound = Real(size + 1.0);
+    return -bound + Real(u) * 2 * bound;
+}
+
 // default shrinkers
 
 template<class T>
@@ -127,20 +163,80 @@ std::vector<Real> shrinkReal(Real x)
 }
 
 
+// default enumerations (see enumSize in Generator.h)
+
+template<class Integral>
+std::size_t enumSizeIntegral(std::size_t depth)
+{
+    const std::size_t bound = std::size_t(std::min<std::uintmax_t>(depth,
+        std::numeric_limits<Integral>::max()));
+    if (!std::numeric_limits<Integral>::is_signed)
+        return detail::saturatingAdd(bound, 1);
+    return detail::saturatingAdd(detail::saturatingMul(bound, 2), 1);
+}
+
+// 0, 1, -1, 2, -2, ... (0, 1, 2, ... if unsigned)
+template<class Integral>
+Integral enumIntegral(std::size_t index, std::size_t /*depth*/)
+{
+    if (!std::numeric_limits<Integral>::is_signed)
+        return Integral(index);
+    const Integral n = Integral((index + 1) / 2);
+    return index % 2 == 1 ? n : Integral(-n);
+}
+
+namespace detail {
+    // the types ArbitraryImpl draws by arbitrarySizedBoundedIntegral: the
+    // integral types but bool and the character types
+    template<class T>
+    struct IsSizedIntegral : std::integral_constant<bool,
+        std::is_integral<T>::value && !std::is_same<T, bool>::value &&
+        !std::is_same<T, char>::value && !std::is_same<T, wchar_t>::value &&
+        !std::is_same<T, char16_t>::value &&
+        !std::is_same<T, char32_t>::value>
+    {
+    };
+}
+
 template<class T>
 struct Arbitrary
 {
     typedef boost::function<T (RngEngine &, std::size_t)> unGenType;
     typedef boost::function<std::vector<T> (T)> shrinkType;
+    typedef boost::function<std::size_t (std::size_t)> enumSizeType;
+    typedef boost::function<T (std::size_t, std::size_t)> enumAtType;
 
     static const unGenType unGen;
     static const shrinkType shrink;
+    // throw NotEnumerable unless ArbitraryImpl<T> implements them
+    static const enumSizeType enumSize;
+    static const enumAtType enumAt;
+
+    // only for the floating point types, which are drawn by
+    // arbitrarySizedReal
+    template<class U = T>
+    static typename std::enable_if<std::is_floating_point<U>::value, U>::type
+    quantile(double u, std::size_t size)
+    {
+        return arbitrarySizedRealQuantile<U>(u, size);
+    }
+
+    // only for the integral types drawn by arbitrarySizedBoundedIntegral
+    template<class U = T>
+    static typename std::enable_if<detail::IsSizedIntegral<U>::value, U>::type
+    quantile(double u, std::size_t size)
+    {
+        return arbitrarySizedIntegralQuantile<U>(u, size);
+    }
 };
 
 /*
  * specialize ArbitraryImpl and implement the members:
  *     static const Arbitrary<T>::unGenType unGen;
  *     static const Arbitrary<T>::shrinkType shrink;
+ * and, to make the values enumerable, optionally:
+ *     static const Arbitrary<T>::enumSizeType enumSize;
+ *     static const Arbitrary<T>::enumAtType enumAt;
  */
 template<class T>
 struct ArbitraryImpl
@@ -166,11 +262,70 @@ const typename Arbitrary<T>::shrinkType Arbitrary<T>::shrink = [](const T &v) {
     return ArbitraryImpl<T>::shrink(v);
 };
 
+namespace detail {
+    template<class T>
+    struct HasArbitraryEnumeration
+    {
+    private:
+        template<class U>
+        static char test(decltype(&ArbitraryImpl<U>::enumSize));
+        template<class U>
+        static long test(...);
+    public:
+        static const bool value = sizeof(test<T>(nullptr)) == 1;
+    };
+
+    template<class T>
+    typename std::enable_if<HasArbitraryEnumeration<T>::value,
+                            std::size_t>::type
+    arbitraryEnumSize(std::size_t depth)
+    {
+        return ArbitraryImpl<T>::enumSize(depth);
+    }
+
+    template<class T>
+    typename std::enable_if<!HasArbitraryEnumeration<T>::value,
+                            std::size_t>::type
+    arbitraryEnumSize(std::size_t)
+    {
+        throw NotEnumerable();
+    }
+
+    template<class T>
+    typename std::enable_if<HasArbitraryEnumeration<T>::value, T>::type
+    arbitraryEnumAt(std::size_t index, std::size_t depth)
+    {
+        return ArbitraryImpl<T>::enumAt(index, depth);
+    }
+
+    template<class T>
+    typename std::enable_if<!HasArbitraryEnumeration<T>::value, T>::type
+    arbitraryEnumAt(std::size_t, std::size_t)
+    {
+        throw NotEnumerable();
+    }
+}
+
+// (function call is needed: see above)
+template<class T>
+const typename Arbitrary<T>::enumSizeType Arbitrary<T>::enumSize =
+    [](std::size_t depth) {
+    return detail::arbitraryEnumSize<T>(depth);
+};
+
+// (function call is needed: see above)
+template<class T>
+const typename Arbitrary<T>::enumAtType Arbitrary<T>::enumAt =
+    [](std::size_t index, std::size_t depth) {
+    return detail::arbitraryEnumAt<T>(index, depth);
+};
+
 // included specializations
 
 inline bool arbitraryBool(RngEngine &rng, std::size_t /*size*/)
 {
-    if (boost::uniform_smallint<int>(0, 1)(rng))
+    constexpr detail::UniformIntSampler<int> coin(0, 1);
+    if (coin(rng))
         return true;
     return false;
 }
@@ -180,11 +335,21 @@ inline std::vector<bool> shrinkBool(bool x)
     if (x) ret.push_back(false);
     return ret;
 }
+inline std::size_t enumSizeBool(std::size_t /*depth*/)
+{
+    return 2;
+}
+inline bool enumBool(std::size_t index, std::size_t /*depth*/)
+{
+    return index == 1;
+}
 template<>
 struct ArbitraryImpl<bool>
 {
     static const Arbitrary<bool>::unGenType unGen;
     static const Arbitrary<bool>::shrinkType shrink;
+    static const Arbitrary<bool>::enumSizeType enumSize;
+    static const Arbitrary<bool>::enumAtType enumAt;
 };
 
 template<>
@@ -192,6 +357,8 @@ struct ArbitraryImpl<signed char>
 {
     static const Arbitrary<signed char>::unGenType unGen;
     static const Arbitrary<signed char>::shrinkType shrink;
+    static const Arbitrary<signed char>::enumSizeType enumSize;
+    static const Arbitrary<signed char>::enumAtType enumAt;
 };
 
 template<>
@@ -199,6 +366,8 @@ struct ArbitraryImpl<unsigned char>
 {
     static const Arbitrary<unsigned char>::unGenType unGen;
     static const Arbitrary<unsigned char>::shrinkType shrink;
+    static const Arbitrary<unsigned char>::enumSizeType enumSize;
+    static const Arbitrary<unsigned char>::enumAtType enumAt;
 };
 
 template<>
@@ -206,6 +375,8 @@ struct ArbitraryImpl<signed short>
 {
     static const Arbitrary<signed short>::unGenType unGen;
     static const Arbitrary<signed short>::shrinkType shrink;
+    static const Arbitrary<signed short>::enumSizeType enumSize;
+    static const Arbitrary<signed short>::enumAtType enumAt;
 };
 
 template<>
@@ -213,6 +384,8 @@ struct ArbitraryImpl<unsigned short>
 {
     static const Arbitrary<unsigned short>::unGenType unGen;
     static const Arbitrary<unsigned short>::shrinkType shrink;
+    static const Arbitrary<unsigned short>::enumSizeType enumSize;
+    static const Arbitrary<unsigned short>::enumAtType enumAt;
 };
 
 template<>
@@ -220,6 +393,8 @@ struct ArbitraryImpl<signed int>
 {
     static const Arbitrary<signed int>::unGenType unGen;
     static const Arbitrary<signed int>::shrinkType shrink;
+    static const Arbitrary<signed int>::enumSizeType enumSize;
+    static const Arbitrary<signed int>::enumAtType enumAt;
 };
 
 template<>
@@ -227,6 +402,8 @@ struct ArbitraryImpl<unsigned int>
 {
     static const Arbitrary<unsigned int>::unGenType unGen;
     static const Arbitrary<unsigned int>::shrinkType shrink;
+    static const Arbitrary<unsigned int>::enumSizeType enumSize;
+    static const Arbitrary<unsigned int>::enumAtType enumAt;
 };
 
 template<>
@@ -234,6 +411,8 @@ struct ArbitraryImpl<signed long>
 {
     static const Arbitrary<signed long>::unGenType unGen;
     static const Arbitrary<signed long>::shrinkType shrink;
+    static const Arbitrary<signed long>::enumSizeType enumSize;
+    static const Arbitrary<signed long>::enumAtType enumAt;
 };
 
 template<>
@@ -241,6 +420,8 @@ struct ArbitraryImpl<unsigned long>
 {
     static const Arbitrary<unsigned long>::unGenType unGen;
     static const Arbitrary<unsigned long>::shrinkType shrink;
+    static const Arbitrary<unsigned long>::enumSizeType enumSize;
+    static const Arbitrary<unsigned long>::enumAtType enumAt;
 };
 
 template<>
@@ -266,7 +447,7 @@ struct ArbitraryImpl<long double>
 
 inline char arbitraryChar(RngEngine &rng, std::size_t)
 {
-    boost::uniform_int<char> dist(0x20, 0x7f);
+    constexpr detail::UniformIntSampler<char> dist(0x20, 0x7f);
     return dist(rng);
 }
 inline std::vector<char> shrinkChar(char c)
@@ -301,8 +482,7 @@ struct ArbitraryImpl<wchar_t>
 template<class String>
 String arbitraryString(RngEngine &rng, std::size_t size)
 {
-    boost::uniform_int<std::size_t> dist(0, size);
-    std::size_t n = dist(rng);
+    std::size_t n = detail::uniformInt<std::size_t>(rng, 0, size);
     String ret;
     ret.reserve(n);
     while (n-- > 0)
@@ -380,6 +560,8 @@ struct ArbitraryImpl<std::vector<T>>
 {
   static const typename Arbitrary<std::vector<T>>::unGenType unGen;
   static const typename Arbitrary<std::vector<T>>::shrinkType shrink;
+  static const typename Arbitrary<std::vector<T>>::enumSizeType enumSize;
+  static const typename Arbitrary<std::vector<T>>::enumAtType enumAt;
 };
 
 template <typename T>
@@ -398,12 +580,29 @@ const typename Arbitrary<std::vector<T>>::shrinkType
     return vectorGenerator.shrink(v);
 };
 
+template <typename T>
+const typename Arbitrary<std::vector<T>>::enumSizeType
+    ArbitraryImpl<std::vector<T>>::enumSize = [](std::size_t depth) {
+    const auto& vectorGenerator = listOf<T>();
+    return vectorGenerator.enumSize(depth);
+};
+
+template <typename T>
+const typename Arbitrary<std::vector<T>>::enumAtType
+    ArbitraryImpl<std::vector<T>>::enumAt = [](std::size_t index,
+                                               std::size_t depth) {
+    const auto& vectorGenerator = listOf<T>();
+    return vectorGenerator.enumAt(index, depth);
+};
+
 
 template<typename T, std::size_t N>
 struct ArbitraryImpl<std::array<T, N>>
 {
     static const typename Arbitrary<std::array<T, N>>::unGenType unGen;
     static const typename Arbitrary<std::array<T, N>>::shrinkType shrink;
+    static const typename Arbitrary<std::array<T, N>>::enumSizeType enumSize;
+    static const typename Arbitrary<std::array<T, N>>::enumAtType enumAt;
 };
 
 /// Note: N is the fixed size of the array.
@@ -427,6 +626,21 @@ const typename Arbitrary<std::array<T, N>>::shrinkType
     return arrayGenerator.shrink(arr);
 };
 
+template <typename T, std::size_t N>
+const typename Arbitrary<std::array<T, N>>::enumSizeType
+    ArbitraryImpl<std::array<T, N>>::enumSize = [](std::size_t depth) {
+    const auto& arrayGenerator = arrayOf<T, N>();
+    return arrayGenerator.enumSize(depth);
+};
+
+template <typename T, std::size_t N>
+const typename Arbitrary<std::array<T, N>>::enumAtType
+    ArbitraryImpl<std::array<T, N>>::enumAt = [](std::size_t index,
+                                                 std::size_t depth) {
+    const auto& arrayGenerator = arrayOf<T, N>();
+    return arrayGenerator.enumAt(index, depth);
+};
+
 }
 
 #endif
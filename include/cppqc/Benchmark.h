@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_BENCHMARK_H
+#define CPPQC_BENCHMARK_H
+
+#include "Generator.h"
+#include "Measurement.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace cppqc {
+
+enum BenchmarkStatus
+{
+    BENCH_BASELINE_WRITTEN, // No baseline existed; the current run became it
+    BENCH_UNCHANGED, // No significant difference to the baseline
+    BENCH_FASTER, // Significantly faster than the baseline
+    BENCH_SLOWER // Significantly slower than the baseline
+};
+
+struct BenchmarkResult
+{
+    BenchmarkStatus status;
+    // total wall time in nanoseconds of each round over all inputs
+    std::vector<double> samples;
+    std::vector<double> baseline;
+    // mean(samples) / mean(baseline) and its bootstrap confidence interval
+    double ratio;
+    double ratioLow;
+    double ratioHigh;
+
+    bool regressed() const
+    {
+        return status == BENCH_SLOWER;
+    }
+};
+
+namespace detail {
+    const char *const BENCHMARK_FILE_MAGIC = "cppqc-benchmark-baseline";
+
+    inline double mean(const std::vector<double> &values)
+    {
+        double sum = 0;
+        for (double v : values)
+            sum += v;
+        return values.empty() ? 0.0 : sum / values.size();
+    }
+
+    inline double resampledMean(RngEngine &rng,
+                                const std::vector<double> &values)
+    {
+        const UniformIntSampler<std::size_t> pick(0, values.size() - 1);
+        double sum = 0;
+        for (std::size_t i = 0; i < values.size(); ++i)
+            sum += values[pick(rng)];
+        return sum / values.size();
+    }
+
+    /// Percentile bootstrap confidence interval of
+    /// mean(current) / mean(baseline).
+    inline std::pair<double, double> bootstrapRatioInterval(
+            const std::vector<double> &baseline,
+            const std::vector<double> &current,
+            double confidence = 0.95, std::size_t resamples = 2000,
+            SeedType seed = 0)
+    {
+        RngEngine rng(seed);
+        std::vector<double> ratios;
+        ratios.reserve(resamples);
+        for (std::size_t i = 0; i < resamples; ++i) {
+            const double base = resampledMean(rng, baseline);
+            ratios.push_back(base > 0 ? resampledMean(rng, current) / base
+                                      : 1.0);
+        }
+        std::sort(ratios.begin(), ratios.end());
+        const double alpha = (1 - confidence) / 2;
+        const std::size_t lo = std::size_t(alpha * (resamples - 1));
+        const std::size_t hi = std::size_t((1 - alpha) * (resamples - 1));
+        return std::make_pair(ratios[lo], ratios[hi]);
+    }
+
+    inline std::string benchmarkWorkload(SeedType seed, std::size_t numInputs,
+                                         std::size_t maxSize)
+    {
+        std::ostringstream s;
+        s << "seed " << seed << " inputs " << numInputs
+          << " maxSize " << maxSize;
+        return s.str();
+    }
+
+    inline bool readBaseline(const std::string &path,
+                             const std::string &workload,
+                             std::vector<double> &samples)
+    {
+        std::ifstream in(path.c_str());
+        if (!in)
+            return false;
+
+        std::string magic, storedWorkload;
+        std::getline(in, magic);
+        std::getline(in, storedWorkload);
+        if (magic != BENCHMARK_FILE_MAGIC)
+            throw std::runtime_error("Not a benchmark baseline file: " + path);
+        if (storedWorkload != workload)
+            throw std::runtime_error("Benchmark baseline " + path +
+                " was recorded for a different workload (" + storedWorkload +
+                " instead of " + workload + "); delete it to record a new one");
+
+        double sample;
+        while (in >> sample)
+            samples.push_back(sample);
+        if (samples.size() < 2)
+            throw std::runtime_error("Benchmark baseline " + path +
+                                     " has too few samples");
+        return true;
+    }
+
+    inline void writeBaseline(const std::string &path,
+                              const std::string &workload,
+                              const std::vector<double> &samples)
+    {
+        std::ofstream out(path.c_str());
+        out << BENCHMARK_FILE_MAGIC << '\n' << workload << '\n';
+        out.precision(17);
+        for (double sample : samples)
+            out << sample << '\n';
+        if (!out)
+            throw std::runtime_error("Failed to write benchmark baseline " +
+                                     path);
+    }
+}
+
+/// Times f over a fixed set of inputs drawn from gen and compares the
+/// result against a baseline file.
+///
+/// The inputs are generated once from the given seed with sizes growing
+/// up to maxSize, exactly as a property run would draw them, so the same
+/// seed reproduces the same workload across runs. Each of the rounds
+/// times f over the whole input set, after one untimed warm-up round.
+///
+/// If baselineFile does not exist, the samples are written to it and
+/// BENCH_BASELINE_WRITTEN is returned. Otherwise, a bootstrap confidence
+/// interval of the ratio of the mean round times is computed, and
+/// BENCH_SLOWER is returned only if the whole interval lies above
+/// 1 + tolerance; noise alone does not fail the benchmark.
+template<class T, class F>
+BenchmarkResult benchmarkAgainstBaseline(const std::string &baselineFile,
+        Generator<T> gen, F f, std::ostream &out = std::cout,
+        std::size_t numInputs = 100, std::size_t rounds = 20,
+        std::size_t maxSize = 0, double tolerance = 0.05,
+        double confidence = 0.95, SeedType seed = 0)
+{
+    if (maxSize == 0)
+        maxSize = 100;
+    if (rounds < 2)
+        rounds = 2;
+
+    RngEngine rng(seed);
+    std::vector<T> inputs;
+    inputs.reserve(numInputs);
+    for (std::size_t i = 0; i < numInputs; ++i) {
+        rng.startTestCase();
+        inputs.push_back(gen.unGen(rng, i * maxSize / numInputs));
+    }
+
+    const auto runAll = [&] {
+        for (const T &input : inputs)
+            f(input);
+    };
+    runAll();
+
+    BenchmarkResult ret;
+    ret.samples.reserve(rounds);
+    for (std::size_t i = 0; i < rounds; ++i)
+        ret.samples.push_back(measureNanoseconds(runAll));
+
+    const std::string workload =
+        detail::benchmarkWorkload(seed, numInputs, maxSize);
+    if (!detail::readBaseline(baselineFile, workload, ret.baseline)) {
+        detail::writeBaseline(baselineFile, workload, ret.samples);
+        ret.status = BENCH_BASELINE_WRITTEN;
+        ret.ratio = ret.ratioLow = ret.ratioHigh = 1.0;
+        out << "Recorded benchmark baseline in " << baselineFile
+            << " (mean " << detail::mean(ret.samples) << " ns per round)."
+            << std::endl;
+        return ret;
+    }
+
+    const double baselineMean = detail::mean(ret.baseline);
+    ret.ratio = baselineMean > 0 ?
+        detail::mean(ret.samples) / baselineMean : 1.0;
+    const std::pair<double, double> interval =
+        detail::bootstrapRatioInterval(ret.baseline, ret.samples, confidence);
+    ret.ratioLow = interval.first;
+    ret.ratioHigh = interval.second;
+
+    if (ret.ratioLow > 1 + tolerance)
+        ret.status = BENCH_SLOWER;
+    else if (ret.ratioHigh < 1 / (1 + tolerance))
+        ret.status = BENCH_FASTER;
+    else
+        ret.status = BENCH_UNCHANGED;
+
+    out << "Benchmark against " << baselineFile << ": " << ret.ratio
+        << "x the baseline time (" << confidence * 100 << "% CI "
+        << ret.ratioLow << ".." << ret.ratioHigh << ")";
+    switch (ret.status) {
+        case BENCH_SLOWER: out << ", significantly slower"; break;
+        case BENCH_FASTER: out << ", significantly faster"; break;
+        default: out << ", no significant change"; break;
+    }
+    out << '.' << std::endl;
+    return ret;
+}
+
+}
+
+#endif
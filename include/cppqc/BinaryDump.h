@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_BINARY_DUMP_H
+#define CPPQC_BINARY_DUMP_H
+
+#include "PrettyPrint.h"
+
+#include <cstdint>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace cppqc {
+
+/*
+ * BinaryDump<T> writes values of type T to a binary stream, so that huge
+ * counterexamples can be kept in full without printing them (see
+ * PrintLimits::dumpFile). The layout is the in-memory representation of
+ * trivially copyable types, a 64 bit element count followed by the
+ * elements for strings and containers, and the members in order for pairs
+ * and tuples. All integers use the byte order of the host.
+ *
+ * Specialize BinaryDump for other types:
+ *
+ *      template<>
+ *      struct BinaryDump<MyType>
+ *      {
+ *          static const bool supported = true;
+ *          static void write(std::ostream &out, const MyType &x);
+ *      };
+ */
+template<class T, class Enable = void>
+struct BinaryDump
+{
+    static const bool supported = false;
+};
+
+namespace detail {
+    inline void writeDumpSize(std::ostream &out, std::uint64_t n)
+    {
+        out.write(reinterpret_cast<const char *>(&n), sizeof(n));
+    }
+
+    template<class... T>
+    struct AllDumpable;
+
+    template<>
+    struct AllDumpable<> : std::true_type {};
+
+    template<class T, class... Rest>
+    struct AllDumpable<T, Rest...> : std::integral_constant<bool,
+        BinaryDump<T>::supported && AllDumpable<Rest...>::value> {};
+
+    template<class T>
+    struct IsDumpableContainer : std::integral_constant<bool,
+        IsBoundedContainer<T>::value &&
+        !std::is_same<T, std::string>::value> {};
+}
+
+template<class T>
+struct BinaryDump<T, typename std::enable_if<
+    std::is_trivially_copyable<T>::value && !std::is_pointer<T>::value &&
+    !pretty_print::is_container<T>::value>::type>
+{
+    static const bool supported = true;
+
+    static void write(std::ostream &out, const T &x)
+    {
+        out.write(reinterpret_cast<const char *>(&x), sizeof(T));
+    }
+};
+
+template<>
+struct BinaryDump<std::string>
+{
+    static const bool supported = true;
+
+    static void write(std::ostream &out, const std::string &x)
+    {
+        detail::writeDumpSize(out, x.size());
+        out.write(x.data(), x.size());
+    }
+};
+
+template<class T1, class T2>
+struct BinaryDump<std::pair<T1, T2>>
+{
+    static const bool supported = detail::AllDumpable<T1, T2>::value;
+
+    static void write(std::ostream &out, const std::pair<T1, T2> &x)
+    {
+        BinaryDump<T1>::write(out, x.first);
+        BinaryDump<T2>::write(out, x.second);
+    }
+};
+
+template<class... T>
+struct BinaryDump<std::tuple<T...>>
+{
+    static const bool supported = detail::AllDumpable<T...>::value;
+
+    static void write(std::ostream &out, const std::tuple<T...> &x)
+    {
+        writeElements<0>(out, x);
+    }
+
+private:
+    template<std::size_t I>
+    static typename std::enable_if<I == sizeof...(T)>::type
+    writeElements(std::ostream &, const std::tuple<T...> &)
+    {
+    }
+
+    template<std::size_t I>
+    static typename std::enable_if<I < sizeof...(T)>::type
+    writeElements(std::ostream &out, const std::tuple<T...> &x)
+    {
+        typedef typename std::tuple_element<I, std::tuple<T...>>::type E;
+        BinaryDump<E>::write(out, std::get<I>(x));
+        writeElements<I + 1>(out, x);
+    }
+};
+
+template<class C>
+struct BinaryDump<C, typename std::enable_if<
+    detail::IsDumpableContainer<C>::value>::type>
+{
+    typedef typename C::value_type Element;
+
+    static const bool supported = BinaryDump<Element>::supported;
+
+    static void write(std::ostream &out, const C &c)
+    {
+        detail::writeDumpSize(out, std::distance(c.begin(), c.end()));
+        for (const Element &e : c)
+            BinaryDump<Element>::write(out, e);
+    }
+};
+
+namespace detail {
+    template<class T>
+    typename std::enable_if<BinaryDump<T>::supported>::type
+    dumpTo(std::ostream &out, const T &x)
+    {
+        BinaryDump<T>::write(out, x);
+    }
+
+    template<class T>
+    typename std::enable_if<!BinaryDump<T>::supported>::type
+    dumpTo(std::ostream &, const T &)
+    {
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,300 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_CHECKPOINT_H
+#define CPPQC_CHECKPOINT_H
+
+#include "Test.h"
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+// Checkpoints let long runs continue after they were interrupted. The
+// runner state (seed, run parameters, counters, labels and measurements)
+// is written to a small text file every few test cases. As each test case
+// has its own generator, a resumed run continues with the next test case
+// directly, without regenerating or checking the ones before it.
+
+namespace cppqc {
+
+namespace detail {
+    const char *const CHECKPOINT_FILE_MAGIC = "cppqc-checkpoint 3";
+    // still read; it has no measurement histograms
+    const char *const CHECKPOINT_FILE_MAGIC_V2 = "cppqc-checkpoint 2";
+    // still read; it has no count of duplicates either
+    const char *const CHECKPOINT_FILE_MAGIC_V1 = "cppqc-checkpoint 1";
+
+    inline void writeCheckpointString(std::ostream &out, const std::string &s)
+    {
+        out << s.size() << ' ' << s << '\n';
+    }
+
+    inline std::string readCheckpointString(std::istream &in)
+    {
+        std::size_t length = 0;
+        in >> length;
+        in.get();
+        std::string s(length, '\0');
+        in.read(&s[0], std::streamsize(length));
+        return s;
+    }
+
+    inline void writeMeasurementTable(std::ostream &out,
+                                      const MeasurementTable &table)
+    {
+        out << table.size() << '\n';
+        for (const auto &m : table) {
+            writeCheckpointString(out, m.first);
+            out << m.second.count << ' ' << m.second.sum << ' '
+                << m.second.min << ' ' << m.second.max << ' '
+                << m.second.histogram.size();
+            for (const auto &bucket : m.second.histogram)
+                out << ' ' << bucket.first << ' ' << bucket.second;
+            out << '\n';
+        }
+    }
+
+    inline MeasurementTable readMeasurementTable(std::istream &in,
+                                                 bool withHistogram)
+    {
+        MeasurementTable table;
+        std::size_t n = 0;
+        in >> n;
+        for (std::size_t i = 0; i < n && in; ++i) {
+            MeasurementStats &stats = table[readCheckpointString(in)];
+            in >> stats.count >> stats.sum >> stats.min >> stats.max;
+            std::size_t buckets = 0;
+            if (withHistogram)
+                in >> buckets;
+            for (std::size_t j = 0; j < buckets && in; ++j) {
+                double bucket = 0;
+                in >> bucket;
+                in >> stats.histogram[bucket];
+            }
+        }
+        return table;
+    }
+
+    inline void writeCheckpoint(const std::string &path,
+            const std::string &propertyName, const RunState &state)
+    {
+        // write a new file and rename it, so that an interruption while
+        // writing keeps the previous checkpoint intact
+        const std::string tmpPath = path + ".tmp";
+        {
+            std::ofstream out(tmpPath.c_str(), std::ios::trunc);
+            out.precision(std::numeric_limits<double>::max_digits10);
+            out << CHECKPOINT_FILE_MAGIC << '\n';
+            writeCheckpointString(out, propertyName);
+            out << state.seed << ' ' << state.maxSuccess << ' '
+                << state.maxDiscarded << ' ' << state.maxSize << '\n'
+                << state.numSuccess << ' ' << state.numDiscarded << ' '
+                << state.numTrivial << ' ' << state.numDuplicates << '\n';
+
+            out << state.labelsCollected.size() << '\n';
+            for (const auto &label : state.labelsCollected) {
+                writeCheckpointString(out, label.first);
+                out << label.second << '\n';
+            }
+            out << state.measurementsCollected.size() << '\n';
+            for (const auto &label : state.measurementsCollected) {
+                writeCheckpointString(out, label.first);
+                writeMeasurementTable(out, label.second);
+            }
+            out << state.measurementsBySize.size() << '\n';
+            for (const auto &bucket : state.measurementsBySize) {
+                out << bucket.first << '\n';
+                writeMeasurementTable(out, bucket.second);
+            }
+            if (!out)
+                throw std::runtime_error("Failed to write checkpoint " +
+                                         tmpPath);
+        }
+        if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+            throw std::runtime_error("Failed to replace checkpoint " + path);
+    }
+
+    // Returns false if there is no checkpoint.
+    inline bool readCheckpoint(const std::string &path,
+            const std::string &propertyName, RunState &state)
+    {
+        std::ifstream in(path.c_str());
+        if (!in)
+            return false;
+
+        std::string magic;
+        std::getline(in, magic);
+        const bool v1 = magic == CHECKPOINT_FILE_MAGIC_V1;
+        const bool v2 = magic == CHECKPOINT_FILE_MAGIC_V2;
+        if (magic != CHECKPOINT_FILE_MAGIC && !v1 && !v2)
+            throw std::runtime_error("Not a checkpoint file: " + path);
+        const std::string storedName = readCheckpointString(in);
+        if (storedName != propertyName)
+            throw std::runtime_error("Checkpoint " + path +
+                " belongs to property \"" + storedName + "\", not \"" +
+                propertyName + "\"");
+
+        in >> state.seed >> state.maxSuccess >> state.maxDiscarded
+           >> state.maxSize >> state.numSuccess >> state.numDiscarded
+           >> state.numTrivial;
+        if (!v1)
+            in >> state.numDuplicates;
+
+        std::size_t n = 0;
+        in >> n;
+        for (std::size_t i = 0; i < n && in; ++i) {
+            const std::string label = readCheckpointString(in);
+            in >> state.labelsCollected[label];
+        }
+        in >> n;
+        for (std::size_t i = 0; i < n && in; ++i) {
+            const std::string label = readCheckpointString(in);
+            state.measurementsCollected[label] =
+                readMeasurementTable(in, !v1 && !v2);
+        }
+        in >> n;
+        for (std::size_t i = 0; i < n && in; ++i) {
+            std::size_t bucket = 0;
+            in >> bucket;
+            state.measurementsBySize[bucket] =
+                readMeasurementTable(in, !v1 && !v2);
+        }
+        if (!in || state.maxSuccess == 0)
+            throw std::runtime_error("Corrupt checkpoint file: " + path);
+        return true;
+    }
+
+    class CheckpointWriter
+    {
+        public:
+            CheckpointWriter(const std::string &path,
+                             const std::string &propertyName,
+                             std::size_t interval) :
+                m_path(path), m_propertyName(propertyName),
+                m_interval(interval == 0 ? 1 : interval), m_sinceLast(0)
+            {
+            }
+
+            void operator()(const RunState &state)
+            {
+                if (++m_sinceLast >= m_interval) {
+                    writeCheckpoint(m_path, m_propertyName, state);
+                    m_sinceLast = 0;
+                }
+            }
+
+        private:
+            const std::string m_path;
+            const std::string m_propertyName;
+            const std::size_t m_interval;
+            std::size_t m_sinceLast;
+    };
+
+    template<class T0, class T1, class T2, class T3, class T4>
+    Result runCheckpointed(const Property<T0, T1, T2, T3, T4> &prop,
+            const std::string &checkpointFile, std::ostream &out,
+            RunState &state, bool resumed,
+            std::chrono::duration<double> shrinkTimeout,
+            std::size_t checkpointInterval)
+    {
+        StreamReporter reporter(out);
+        reporter.start(prop);
+        if (resumed) {
+            out << "Resuming from " << checkpointFile << " after "
+                << state.numSuccess << " tests (seed " << state.seed
+                << ")." << std::endl;
+        }
+
+        CheckpointWriter writer(checkpointFile, prop.name(),
+                                checkpointInterval);
+        const Result result = runTests(prop, reporter, state, shrinkTimeout,
+                                       nullptr, writer);
+        // the run is complete; the next one starts from the beginning
+        std::remove(checkpointFile.c_str());
+        return result;
+    }
+}
+
+/// Like quickCheckOutput, but writes the runner state to checkpointFile
+/// every checkpointInterval test cases. If checkpointFile exists, the run
+/// continues from it instead of starting over; it must have been written
+/// for the same property, number of tests and size (and seed, unless the
+/// default seed is used). The checkpoint is removed when the run ends.
+template<class T0, class T1, class T2, class T3, class T4>
+Result quickCheckCheckpointed(const Property<T0, T1, T2, T3, T4> &prop,
+        const std::string &checkpointFile,
+        std::ostream &out = std::cout,
+        std::size_t maxSuccess = 100,
+        std::size_t maxDiscarded = 0, std::size_t maxSize = 0,
+        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
+        SeedType seed = USE_DEFAULT_SEED,
+        std::size_t checkpointInterval = 10000)
+{
+    detail::RunState state;
+    const bool resumed =
+        detail::readCheckpoint(checkpointFile, prop.name(), state);
+    if (resumed) {
+        const detail::RunState requested = detail::initialRunState(
+            maxSuccess, maxDiscarded, maxSize,
+            seed == USE_DEFAULT_SEED ? state.seed : seed);
+        if (requested.seed != state.seed ||
+                requested.maxSuccess != state.maxSuccess ||
+                requested.maxSize != state.maxSize) {
+            throw std::runtime_error("Checkpoint " + checkpointFile +
+                " was written for a run with other parameters; delete it "
+                "to start over");
+        }
+    } else {
+        state = detail::initialRunState(maxSuccess, maxDiscarded, maxSize,
+                                        seed);
+    }
+    return detail::runCheckpointed(prop, checkpointFile, out, state,
+                                   resumed, shrinkTimeout,
+                                   checkpointInterval);
+}
+
+/// Continues the run saved in checkpointFile with the parameters stored
+/// in it. Throws std::runtime_error if there is no checkpoint.
+template<class T0, class T1, class T2, class T3, class T4>
+Result quickCheckResume(const Property<T0, T1, T2, T3, T4> &prop,
+        const std::string &checkpointFile,
+        std::ostream &out = std::cout,
+        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
+        std::size_t checkpointInterval = 10000)
+{
+    detail::RunState state;
+    if (!detail::readCheckpoint(checkpointFile, prop.name(), state))
+        throw std::runtime_error("No checkpoint to resume: " +
+                                 checkpointFile);
+    return detail::runCheckpointed(prop, checkpointFile, out, state, true,
+                                   shrinkTimeout, checkpointInterval);
+}
+
+}
+
+#endif
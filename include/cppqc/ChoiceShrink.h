@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_CHOICE_SHRINK_H
+#define CPPQC_CHOICE_SHRINK_H
+
+#include "Property.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// Shrinking on the choices a generator made, rather than on the values it
+// generated: while an input is generated, every random number drawn is
+// recorded (see RngEngine::record). If the input fails, the recorded
+// choices are shrunk by deleting, zeroing, sorting and lowering them, and
+// the generator is run again on each candidate (see RngEngine::replay).
+// Because fewer and smaller choices make generators produce shorter and
+// smaller values, this shrinks the inputs of every generator, even of
+// those without a shrink function like vectorOf, noShrink or custom ones.
+//
+// A property shrinks this way if its shrinkStrategy returns
+// SHRINK_CHOICES. The shrunk choices are returned in
+// Result::failedChoices, and generateFromChoices turns them back into the
+// failing input.
+//
+// Generators must draw all their randomness from the RngEngine they are
+// passed for their inputs to be shrunk and replayed this way.
+
+namespace cppqc {
+
+/// Regenerates the input of a property from choices recorded while
+/// checking it, e.g. Result::failedChoices. Throws ChoicesExhausted if the
+/// generator draws more numbers than there are choices.
+template<class T0, class T1, class T2, class T3, class T4>
+typename Property<T0, T1, T2, T3, T4>::Input generateFromChoices(
+        const Property<T0, T1, T2, T3, T4> &prop, const Choices &choices,
+        std::size_t size)
+{
+    RngEngine rng;
+    rng.replay(&choices);
+    return prop.generateInputTree(rng, size).value();
+}
+
+namespace detail {
+    // shorter first, then lexicographically smaller
+    inline bool shortlexLess(const Choices &a, const Choices &b)
+    {
+        return a.size() != b.size() ? a.size() < b.size() : a < b;
+    }
+
+    template<class T0, class T1, class T2, class T3, class T4,
+             class Reporter>
+    class ChoiceShrinker
+    {
+        public:
+            typedef typename Property<T0, T1, T2, T3, T4>::Input Input;
+
+            ChoiceShrinker(const Property<T0, T1, T2, T3, T4> &prop,
+                    std::size_t size, Choices choices, Input input,
+                    std::chrono::duration<double> timeout,
+                    Reporter &reporter) :
+                m_prop(prop), m_size(size), m_timeout(timeout),
+                m_reporter(reporter), m_start(std::chrono::steady_clock::now()),
+                m_timedOut(false), m_numShrinks(0), m_numEvaluations(0),
+                m_choices(std::move(choices)), m_input(std::move(input))
+            {
+            }
+
+            void run()
+            {
+                while (!m_timedOut && pass()) {
+                }
+            }
+
+            std::size_t numShrinks() const { return m_numShrinks; }
+            std::size_t numEvaluations() const { return m_numEvaluations; }
+            const Choices &choices() const { return m_choices; }
+            Input &input() { return m_input; }
+
+        private:
+            // Returns whether any candidate was accepted.
+            bool pass()
+            {
+                bool progress = false;
+                const std::size_t chunks[] = { 8, 4, 3, 2, 1 };
+
+                // from the back, so that deletions do not shift the
+                // choices that are still to be tried
+                for (std::size_t k : chunks) {
+                    for (std::size_t i = m_choices.size(); i-- > 0 &&
+                            !m_timedOut; ) {
+                        if (i + k > m_choices.size())
+                            continue;
+                        Choices c(m_choices);
+                        c.erase(c.begin() + i, c.begin() + i + k);
+                        const Outcome outcome = tryChoices(c);
+                        if (outcome == EXHAUSTED && i > 0)
+                            progress |= tryShorterLength(c, i - 1) == ACCEPTED;
+                        else
+                            progress |= outcome == ACCEPTED;
+                    }
+                }
+
+                for (std::size_t k : chunks) {
+                    for (std::size_t i = 0;
+                            i + k <= m_choices.size() && !m_timedOut; ++i) {
+                        const auto b = m_choices.begin() + i;
+                        if (std::all_of(b, b + k,
+                                [](std::uint32_t x) { return x == 0; }))
+                            continue;
+                        Choices c(m_choices);
+                        std::fill(c.begin() + i, c.begin() + i + k, 0);
+                        progress |= tryChoices(c) == ACCEPTED;
+                    }
+                }
+
+                for (std::size_t k : chunks) {
+                    for (std::size_t i = 0; k > 1 &&
+                            i + k <= m_choices.size() && !m_timedOut; ++i) {
+                        const auto b = m_choices.begin() + i;
+                        if (std::is_sorted(b, b + k))
+                            continue;
+                        Choices c(m_choices);
+                        std::sort(c.begin() + i, c.begin() + i + k);
+                        progress |= tryChoices(c) == ACCEPTED;
+                    }
+                }
+
+                // binary search for the smallest value of every choice
+                for (std::size_t i = 0; i < m_choices.size() && !m_timedOut;
+                        ++i) {
+                    std::uint32_t lo = 0, hi = m_choices[i];
+                    while (hi - lo > 1 && !m_timedOut) {
+                        const std::uint32_t mid = lo + (hi - lo) / 2;
+                        Choices c(m_choices);
+                        c[i] = mid;
+                        if (tryChoices(c) == ACCEPTED) {
+                            progress = true;
+                            if (i >= m_choices.size() || m_choices[i] != mid)
+                                break;
+                            hi = mid;
+                        } else {
+                            lo = mid;
+                        }
+                    }
+                }
+                return progress;
+            }
+
+            enum Outcome { ACCEPTED, REJECTED, EXHAUSTED };
+
+            // Accepts the candidate if the input generated from it fails
+            // and the choices it used are smaller than the current ones.
+            Outcome tryChoices(const Choices &candidate)
+            {
+                RngEngine rng;
+                rng.replay(&candidate);
+                std::vector<ShrinkTree<Input>> tree;
+                try {
+                    tree.push_back(m_prop.generateInputTree(rng, m_size));
+                } catch (const ChoicesExhausted &) {
+                    return EXHAUSTED;
+                } catch (...) {
+                    return REJECTED;
+                }
+
+                Choices used(candidate.begin(),
+                             candidate.begin() + rng.numReplayed());
+                if (!shortlexLess(used, m_choices))
+                    return REJECTED;
+
+                ++m_numEvaluations;
+                const bool failed = !m_prop.checkInput(tree[0].value());
+                checkTimeout();
+                if (!failed)
+                    return REJECTED;
+                m_choices = std::move(used);
+                m_input = std::move(tree[0].value());
+                ++m_numShrinks;
+                return ACCEPTED;
+            }
+
+            // After deleting choices made generating run out of them,
+            // choice i may have been a length: lowers it to the highest
+            // value that needs no more choices than are left, and tries
+            // that.
+            Outcome tryShorterLength(Choices c, std::size_t i)
+            {
+                std::uint32_t lo = 0, hi = c[i];
+                while (hi - lo > 1) {
+                    c[i] = lo + (hi - lo) / 2;
+                    if (exhausts(c))
+                        hi = c[i];
+                    else
+                        lo = c[i];
+                }
+                c[i] = lo;
+                // samplers reject some draws and draw the next choice
+                // instead (see UniformIntSampler), so that value may leave
+                // choices unused: then try a few values below it for one
+                // that uses them all
+                if (numUsed(c) < c.size()) {
+                    Choices d(c);
+                    for (std::uint64_t step = 1; step <= lo; step *= 2) {
+                        d[i] = std::uint32_t(lo - step);
+                        if (numUsed(d) == c.size()) {
+                            c = d;
+                            break;
+                        }
+                    }
+                }
+                return tryChoices(c);
+            }
+
+            bool exhausts(const Choices &candidate) const
+            {
+                return numUsed(candidate) > candidate.size();
+            }
+
+            // The number of choices generating uses, or more than there
+            // are if it runs out of them.
+            std::size_t numUsed(const Choices &candidate) const
+            {
+                RngEngine rng;
+                rng.replay(&candidate);
+                try {
+                    m_prop.generateInputTree(rng, m_size);
+                } catch (const ChoicesExhausted &) {
+                    return candidate.size() + 1;
+                } catch (...) {
+                }
+                return rng.numReplayed();
+            }
+
+            void checkTimeout()
+            {
+                const std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - m_start;
+                if (!m_timedOut && elapsed >= m_timeout) {
+                    m_timedOut = true;
+                    m_reporter.shrinkTimedOut();
+                }
+            }
+
+            const Property<T0, T1, T2, T3, T4> &m_prop;
+            const std::size_t m_size;
+            const std::chrono::duration<double> m_timeout;
+            Reporter &m_reporter;
+            const std::chrono::steady_clock::time_point m_start;
+            bool m_timedOut;
+            std::size_t m_numShrinks;
+            std::size_t m_numEvaluations;
+            Choices m_choices;
+            Input m_input;
+    };
+}
+
+}
+
+#endif
@@ -0,0 +1,393 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_COMPLEXITY_H
+#define CPPQC_COMPLEXITY_H
+
+#include "Arbitrary.h"
+#include "Measurement.h"
+#include "Test.h"
+
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cppqc {
+
+/// The complexity classes that measurements are fitted against, ordered
+/// from the cheapest to the most expensive.
+enum ComplexityClass
+{
+    O_1,
+    O_LOG_N,
+    O_N,
+    O_N_LOG_N,
+    O_N_SQUARED
+};
+
+inline const char *complexityName(ComplexityClass c)
+{
+    switch (c) {
+        case O_1: return "O(1)";
+        case O_LOG_N: return "O(log n)";
+        case O_N: return "O(n)";
+        case O_N_LOG_N: return "O(n log n)";
+        case O_N_SQUARED: return "O(n^2)";
+    }
+    return "O(?)";
+}
+
+inline double complexityModel(ComplexityClass c, double n)
+{
+    n = std::max(n, 1.0);
+    switch (c) {
+        case O_1: return 1.0;
+        case O_LOG_N: return std::log2(n);
+        case O_N: return n;
+        case O_N_LOG_N: return n * std::log2(n);
+        case O_N_SQUARED: return n * n;
+    }
+    return 1.0;
+}
+
+/// Result of fitting "cost = constant + coefficient * f(n)".
+struct ComplexityFit
+{
+    ComplexityClass complexity;
+    double constant;
+    double coefficient;
+
+    // root-mean-square error relative to the mean cost
+    double rms;
+};
+
+/// One measurement: the size of the input and the cost of processing it.
+typedef std::pair<double, double> ComplexitySample;
+
+namespace detail {
+    inline ComplexityFit fitModel(ComplexityClass c,
+                                  const std::vector<ComplexitySample> &samples)
+    {
+        const double count = double(samples.size());
+        double sumX = 0, sumY = 0;
+        for (const auto &s : samples) {
+            sumX += complexityModel(c, s.first);
+            sumY += s.second;
+        }
+        const double meanX = sumX / count, meanY = sumY / count;
+
+        double covXY = 0, varX = 0;
+        for (const auto &s : samples) {
+            const double dx = complexityModel(c, s.first) - meanX;
+            covXY += dx * (s.second - meanY);
+            varX += dx * dx;
+        }
+
+        ComplexityFit fit;
+        fit.complexity = c;
+        fit.coefficient = varX > 0 ? covXY / varX : 0.0;
+        fit.constant = meanY - fit.coefficient * meanX;
+
+        double squaredError = 0;
+        for (const auto &s : samples) {
+            const double err = s.second - fit.constant -
+                fit.coefficient * complexityModel(c, s.first);
+            squaredError += err * err;
+        }
+        const double rms = std::sqrt(squaredError / count);
+        fit.rms = meanY != 0 ? rms / std::abs(meanY) : rms;
+        return fit;
+    }
+}
+
+/// Fits the samples against all complexity classes and returns the best
+/// one. A more expensive class is only chosen if it explains the samples
+/// clearly better (relative RMS at least 10% lower) than every cheaper
+/// class, so measurement noise does not promote a linear algorithm to
+/// "n log n". Fits with a negative growth coefficient are ignored.
+inline ComplexityFit fitComplexity(const std::vector<ComplexitySample> &samples)
+{
+    if (samples.empty())
+        throw std::invalid_argument("fitComplexity: no samples");
+
+    const ComplexityClass classes[] = { O_1, O_LOG_N, O_N, O_N_LOG_N,
+                                        O_N_SQUARED };
+    ComplexityFit best = detail::fitModel(O_1, samples);
+    // lowest error of all cheaper classes, chosen or not
+    double cheaperRms = best.rms;
+    for (ComplexityClass c : classes) {
+        if (c == O_1)
+            continue;
+        const ComplexityFit fit = detail::fitModel(c, samples);
+        if (fit.coefficient <= 0)
+            continue;
+        if (fit.rms < cheaperRms * 0.9)
+            best = fit;
+        cheaperRms = std::min(cheaperRms, fit.rms);
+    }
+    return best;
+}
+
+/// A property that does not check a result but how the cost of the code
+/// under test grows with the input size. The runner measures the cost
+/// over the whole size ramp and fails if it grows faster than the
+/// declared complexity class.
+///
+/// Override either "run" (the cost is then the median wall time of
+/// several runs) or "cost" to return a deterministic operation count.
+/// By default, "n" is the generation size parameter; override
+/// "inputSize" to use a property of the input instead (e.g., the number
+/// of elements of a vector).
+template<class... T>
+class ComplexityProperty : public PropertyBase
+{
+    public:
+        typedef std::tuple<T...> Input;
+
+        explicit ComplexityProperty(ComplexityClass bound) :
+            m_bound(bound), m_gen(tupleOf<T...>())
+        {
+        }
+
+        ComplexityProperty(ComplexityClass bound, const Generator<T> &...g) :
+            m_bound(bound), m_gen(tupleOf(g...))
+        {
+        }
+
+        ComplexityClass bound() const
+        {
+            return m_bound;
+        }
+
+        Input generateInput(RngEngine &rng, std::size_t size) const
+        {
+            return m_gen.unGen(rng, size);
+        }
+
+        double costInput(const Input &in) const
+        {
+            return costInput(in,
+                typename detail::MakeIndexList<sizeof...(T)>::type());
+        }
+
+        double inputSizeOf(std::size_t generationSize, const Input &in) const
+        {
+            return inputSizeOf(generationSize, in,
+                typename detail::MakeIndexList<sizeof...(T)>::type());
+        }
+
+    protected:
+        // number of timed runs per input when measuring wall time
+        virtual std::size_t repetitions() const
+        {
+            return 5;
+        }
+
+    private:
+        virtual void run(const T &...) const
+        {
+            throw std::logic_error(
+                "ComplexityProperty: override either run() or cost()");
+        }
+
+        virtual double cost(const T &...v) const
+        {
+            return medianNanoseconds(repetitions(), [&] { run(v...); });
+        }
+
+        virtual double inputSize(std::size_t generationSize,
+                                 const T &...) const
+        {
+            return double(generationSize);
+        }
+
+        template<std::size_t... I>
+        double costInput(const Input &in, detail::IndexList<I...>) const
+        {
+            return cost(std::get<I>(in)...);
+        }
+
+        template<std::size_t... I>
+        double inputSizeOf(std::size_t generationSize, const Input &in,
+                           detail::IndexList<I...>) const
+        {
+            return inputSize(generationSize, std::get<I>(in)...);
+        }
+
+        const ComplexityClass m_bound;
+        const Generator<Input> m_gen;
+};
+
+struct ComplexityResult
+{
+    ResultType result;
+    std::size_t numTests;
+    SeedType seed;
+    ComplexityFit fit;
+
+    // only used if result is QC_FAILURE: the smallest range of input sizes
+    // whose measurements still exceed the declared complexity
+    std::size_t numShrinks;
+    double minFailingSize;
+    double maxFailingSize;
+};
+
+namespace detail {
+    // minimum number of distinct input sizes needed to tell the
+    // complexity classes apart
+    const std::size_t MIN_COMPLEXITY_SIZES = 4;
+
+    inline std::vector<ComplexitySample> samplesInRange(
+            const std::vector<ComplexitySample> &samples,
+            const std::vector<double> &sizes,
+            std::size_t lo, std::size_t hi)
+    {
+        std::vector<ComplexitySample> ret;
+        for (const auto &s : samples) {
+            if (s.first >= sizes[lo] && s.first <= sizes[hi])
+                ret.push_back(s);
+        }
+        return ret;
+    }
+
+    // Narrows the range of input sizes, dropping the smallest or largest
+    // size as long as the remaining samples still exceed the bound.
+    inline std::size_t shrinkComplexityRange(
+            const std::vector<ComplexitySample> &samples,
+            ComplexityClass bound, double &minSize, double &maxSize,
+            ComplexityFit &fit)
+    {
+        std::vector<double> sizes;
+        for (const auto &s : samples)
+            sizes.push_back(s.first);
+        std::sort(sizes.begin(), sizes.end());
+        sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+
+        std::size_t lo = 0, hi = sizes.size() - 1, numShrinks = 0;
+        bool progress = true;
+        while (progress && hi - lo + 1 > MIN_COMPLEXITY_SIZES) {
+            progress = false;
+            const std::size_t candidates[][2] = { { lo + 1, hi },
+                                                  { lo, hi - 1 } };
+            for (const auto &c : candidates) {
+                const ComplexityFit candidateFit =
+                    fitComplexity(samplesInRange(samples, sizes, c[0], c[1]));
+                if (candidateFit.complexity > bound) {
+                    lo = c[0];
+                    hi = c[1];
+                    fit = candidateFit;
+                    ++numShrinks;
+                    progress = true;
+                    break;
+                }
+            }
+        }
+        minSize = sizes[lo];
+        maxSize = sizes[hi];
+        return numShrinks;
+    }
+}
+
+/// Measures the cost of the property over the size ramp (from 0 to maxSize
+/// over numTests inputs) and fits it against the complexity classes.
+template<class... T>
+ComplexityResult quickCheckComplexity(const ComplexityProperty<T...> &prop,
+        std::ostream &out = std::cout,
+        std::size_t numTests = 100,
+        std::size_t maxSize = 0,
+        SeedType seed = USE_DEFAULT_SEED)
+{
+    typedef typename ComplexityProperty<T...>::Input Input;
+
+    out << "* Checking complexity of \"" << prop.name() << "\" (expected "
+        << complexityName(prop.bound()) << ") ..." << std::endl;
+
+    if (maxSize == 0)
+        maxSize = 100;
+    const std::size_t maxDiscarded = numTests * 5;
+
+    ComplexityResult ret;
+    ret.seed = seed = detail::resolveSeed(seed);
+    ret.numShrinks = 0;
+    ret.minFailingSize = ret.maxFailingSize = 0;
+
+    std::vector<ComplexitySample> samples;
+    std::size_t numDiscarded = 0;
+    RngEngine rng{seed};
+    while (samples.size() < numTests) {
+        const std::size_t size = (samples.size() * maxSize + numDiscarded) /
+                                 numTests;
+        Input in;
+        try {
+            rng.startTestCase();
+            in = prop.generateInput(rng, size);
+        } catch (...) {
+            if (++numDiscarded >= maxDiscarded) {
+                out << "*** Gave up! Measured only " << samples.size()
+                    << " inputs." << std::endl;
+                ret.result = QC_GAVE_UP;
+                ret.numTests = samples.size();
+                ret.fit = samples.empty() ? ComplexityFit{O_1, 0, 0, 0} :
+                                            fitComplexity(samples);
+                return ret;
+            }
+            continue;
+        }
+        samples.push_back(ComplexitySample(prop.inputSizeOf(size, in),
+                                           prop.costInput(in)));
+    }
+
+    ret.numTests = samples.size();
+    ret.fit = fitComplexity(samples);
+    if (ret.fit.complexity <= prop.bound()) {
+        out << "+++ OK, cost grows as " << complexityName(ret.fit.complexity)
+            << " over " << ret.numTests << " inputs (relative rms "
+            << ret.fit.rms << ")." << std::endl;
+        ret.result = QC_SUCCESS;
+        return ret;
+    }
+
+    ret.result = QC_FAILURE;
+    ret.numShrinks = detail::shrinkComplexityRange(samples, prop.bound(),
+        ret.minFailingSize, ret.maxFailingSize, ret.fit);
+    out << "*** Failed! Cost grows as " << complexityName(ret.fit.complexity)
+        << " (relative rms " << ret.fit.rms << ")";
+    if (ret.numShrinks > 0) {
+        out << " after " << ret.numShrinks
+            << (ret.numShrinks == 1 ? " shrink" : " shrinks");
+    }
+    out << " for input sizes " << ret.minFailingSize << ".."
+        << ret.maxFailingSize << '\n'
+        << "(To reproduce the test, use "
+        << CPPQUICKCHECK_SEED_ENV << '=' << seed << ")" << std::endl;
+    return ret;
+}
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_DIFFERENTIAL_H
+#define CPPQC_DIFFERENTIAL_H
+
+#include "Arbitrary.h"
+#include "Measurement.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cppqc {
+
+namespace detail {
+    template<class T>
+    typename std::enable_if<std::is_floating_point<T>::value, bool>::type
+    approxEqual(const T &a, const T &b, double tolerance)
+    {
+        if (a == b)
+            return true;
+        const double scale = std::max<double>(1.0,
+            std::max(std::abs(double(a)), std::abs(double(b))));
+        return std::abs(double(a) - double(b)) <= tolerance * scale;
+    }
+
+    template<class T>
+    typename std::enable_if<!std::is_floating_point<T>::value, bool>::type
+    approxEqual(const T &a, const T &b, double)
+    {
+        return a == b;
+    }
+
+    // declared before approxEqualRange, so that elements that are
+    // containers themselves are compared with a tolerance as well
+    template<class T>
+    bool approxEqual(const std::vector<T> &a, const std::vector<T> &b,
+                     double tolerance);
+    template<class T, std::size_t N>
+    bool approxEqual(const std::array<T, N> &a, const std::array<T, N> &b,
+                     double tolerance);
+    template<class T1, class T2>
+    bool approxEqual(const std::pair<T1, T2> &a, const std::pair<T1, T2> &b,
+                     double tolerance);
+
+    template<class T>
+    bool approxEqualRange(const T &a, const T &b, double tolerance)
+    {
+        if (a.size() != b.size())
+            return false;
+        auto j = b.begin();
+        for (auto i = a.begin(); i != a.end(); ++i, ++j) {
+            if (!approxEqual(*i, *j, tolerance))
+                return false;
+        }
+        return true;
+    }
+
+    template<class T>
+    bool approxEqual(const std::vector<T> &a, const std::vector<T> &b,
+                     double tolerance)
+    {
+        return approxEqualRange(a, b, tolerance);
+    }
+
+    template<class T, std::size_t N>
+    bool approxEqual(const std::array<T, N> &a, const std::array<T, N> &b,
+                     double tolerance)
+    {
+        return approxEqualRange(a, b, tolerance);
+    }
+
+    template<class T1, class T2>
+    bool approxEqual(const std::pair<T1, T2> &a, const std::pair<T1, T2> &b,
+                     double tolerance)
+    {
+        return approxEqual(a.first, b.first, tolerance) &&
+               approxEqual(a.second, b.second, tolerance);
+    }
+
+    template<class F>
+    auto timedCall(double &nanoseconds, F f) -> decltype(f())
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto result = f();
+        const std::chrono::duration<double, std::nano> elapsed =
+            std::chrono::steady_clock::now() - start;
+        nanoseconds = elapsed.count();
+        return result;
+    }
+}
+
+/// Checks an optimized implementation against a (slow) reference
+/// implementation. Both are called with the same generated input, and the
+/// property fails if their outputs differ. Floating point outputs (also
+/// inside vectors, arrays and pairs) are compared with the relative
+/// tolerance passed to the constructor; override "equivalent" for other
+/// comparisons.
+///
+/// Each side is timed for every input. The runner reports the timings and
+/// the speedup (reference time / optimized time) per label and per size
+/// bucket, so regressions of the fast path show up even while the results
+/// still match.
+template<class Output, class... T>
+class DifferentialProperty : public Property<T...>
+{
+    public:
+        explicit DifferentialProperty(double tolerance = 0.0) :
+            m_tolerance(tolerance)
+        {
+        }
+
+        DifferentialProperty(double tolerance, const Generator<T> &...g) :
+            Property<T...>(g...), m_tolerance(tolerance)
+        {
+        }
+
+    private:
+        virtual Output reference(const T &...) const = 0;
+        virtual Output optimized(const T &...) const = 0;
+
+        virtual bool equivalent(const Output &expected,
+                                const Output &actual) const
+        {
+            return detail::approxEqual(expected, actual, m_tolerance);
+        }
+
+        bool check(const T &...v) const override
+        {
+            double referenceNs = 0, optimizedNs = 0;
+            const Output expected = detail::timedCall(referenceNs,
+                [&] { return reference(v...); });
+            const Output actual = detail::timedCall(optimizedNs,
+                [&] { return optimized(v...); });
+
+            recordMeasurement("reference ns", referenceNs);
+            recordMeasurement("optimized ns", optimizedNs);
+            if (optimizedNs > 0)
+                recordMeasurement("speedup", referenceNs / optimizedNs);
+            return equivalent(expected, actual);
+        }
+
+        const double m_tolerance;
+};
+
+}
+
+#endif
@@ -0,0 +1,526 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_ENUMERATION_H
+#define CPPQC_ENUMERATION_H
+
+#include "Generator.h"
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Enumerations in the style of Feat ("Functional Enumeration of Algebraic
+// Types", Duregård, Jansson and Wang, 2012): an enumeration counts the
+// values of each size and maps every index below that count to one value,
+// without building the values before it. This gives
+//
+//   * uniform sampling among all values of a size (see uniformOf), where
+//     listOf and recursive generators built with sized skew the shapes
+//     they generate towards some over others, and
+//   * random access for exhaustive checking, so workers can split the
+//     indices of a size between them without coordinating.
+//
+// Enumerations are built from enumSingleton, enumUnion, enumProduct,
+// enumPay, enumMap and enumRecursive. The size of a value is the number
+// of enumPay it passed through, so e.g. enumListsOf pays once per element.
+// Counts that do not fit into std::size_t saturate at its maximum; values
+// of such sizes cannot be indexed.
+
+namespace cppqc {
+
+namespace detail {
+    template<class T>
+    struct EnumNode
+    {
+        virtual ~EnumNode()
+        {
+        }
+        virtual std::size_t count(std::size_t size) const = 0;
+        virtual T at(std::size_t size, std::size_t index) const = 0;
+    };
+
+    // Memoizes the counts of an enumeration. The lock is not held while a
+    // count is computed, as that asks for counts of other nodes, possibly
+    // on other threads; a count computed twice is the same both times.
+    class CountCache
+    {
+        public:
+            template<class F>
+            std::size_t get(std::size_t size, F compute) const
+            {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    const auto it = m_counts.find(size);
+                    if (it != m_counts.end())
+                        return it->second;
+                }
+                const std::size_t n = compute(size);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_counts[size] = n;
+                return n;
+            }
+
+        private:
+            mutable std::mutex m_mutex;
+            mutable std::map<std::size_t, std::size_t> m_counts;
+    };
+}
+
+/// A set of values of type T, partitioned by size, where each value has an
+/// index among the values of its size. Copies share their counts.
+template<class T>
+class Enumeration
+{
+    public:
+        typedef std::shared_ptr<const detail::EnumNode<T>> Node;
+
+        explicit Enumeration(Node node) : m_node(std::move(node))
+        {
+        }
+
+        /// The number of values of exactly this size.
+        std::size_t count(std::size_t size) const
+        {
+            return m_node->count(size);
+        }
+
+        /// The value with the given index among those of the size, which
+        /// must be below count(size).
+        T at(std::size_t size, std::size_t index) const
+        {
+            return m_node->at(size, index);
+        }
+
+        const Node &node() const
+        {
+            return m_node;
+        }
+
+    private:
+        Node m_node;
+};
+
+namespace detail {
+    template<class T>
+    struct SingletonNode : EnumNode<T>
+    {
+        explicit SingletonNode(T x) : value(std::move(x))
+        {
+        }
+
+        std::size_t count(std::size_t size) const override
+        {
+            return size == 0 ? 1 : 0;
+        }
+
+        T at(std::size_t, std::size_t) const override
+        {
+            return value;
+        }
+
+        const T value;
+    };
+
+    template<class T>
+    struct UnionNode : EnumNode<T>
+    {
+        UnionNode(Enumeration<T> a, Enumeration<T> b) :
+            a(std::move(a)), b(std::move(b))
+        {
+        }
+
+        std::size_t count(std::size_t size) const override
+        {
+            return saturatingAdd(a.count(size), b.count(size));
+        }
+
+        T at(std::size_t size, std::size_t index) const override
+        {
+            const std::size_t n = a.count(size);
+            return index < n ? a.at(size, index) : b.at(size, index - n);
+        }
+
+        const Enumeration<T> a;
+        const Enumeration<T> b;
+    };
+
+    // pairs whose sizes add up to the size, the smaller first values first
+    template<class A, class B>
+    struct ProductNode : EnumNode<std::pair<A, B>>
+    {
+        ProductNode(Enumeration<A> a, Enumeration<B> b) :
+            a(std::move(a)), b(std::move(b))
+        {
+        }
+
+        std::size_t count(std::size_t size) const override
+        {
+            return cache.get(size, [this](std::size_t n) {
+                std::size_t ret = 0;
+                for (std::size_t k = 0; k <= n; ++k) {
+                    ret = saturatingAdd(ret, saturatingMul(a.count(k),
+                                                           b.count(n - k)));
+                }
+                return ret;
+            });
+        }
+
+        std::pair<A, B> at(std::size_t size, std::size_t index) const override
+        {
+            for (std::size_t k = 0; ; ++k) {
+                const std::size_t nb = b.count(size - k);
+                const std::size_t n = saturatingMul(a.count(k), nb);
+                if (index < n)
+                    return std::make_pair(a.at(k, index / nb),
+                                          b.at(size - k, index % nb));
+                index -= n;
+            }
+        }
+
+        const Enumeration<A> a;
+        const Enumeration<B> b;
+        CountCache cache;
+    };
+
+    template<class T>
+    struct PayNode : EnumNode<T>
+    {
+        explicit PayNode(Enumeration<T> e) : e(std::move(e))
+        {
+        }
+
+        std::size_t count(std::size_t size) const override
+        {
+            return size == 0 ? 0 : e.count(size - 1);
+        }
+
+        T at(std::size_t size, std::size_t index) const override
+        {
+            return e.at(size - 1, index);
+        }
+
+        const Enumeration<T> e;
+    };
+
+    template<class T, class U>
+    struct MapNode : EnumNode<T>
+    {
+        MapNode(boost::function<T (U)> f, Enumeration<U> e) :
+            f(std::move(f)), e(std::move(e))
+        {
+        }
+
+        std::size_t count(std::size_t size) const override
+        {
+            return e.count(size);
+        }
+
+        T at(std::size_t size, std::size_t index) const override
+        {
+            return f(e.at(size, index));
+        }
+
+        const boost::function<T (U)> f;
+        const Enumeration<U> e;
+    };
+
+    template<class T>
+    struct RecursiveNode : EnumNode<T>
+    {
+        std::size_t count(std::size_t size) const override
+        {
+            return cache.get(size, [this](std::size_t n) {
+                return body->count(n);
+            });
+        }
+
+        T at(std::size_t size, std::size_t index) const override
+        {
+            return body->at(size, index);
+        }
+
+        std::shared_ptr<const EnumNode<T>> body;
+        CountCache cache;
+    };
+
+    // The recursive uses inside the body. They refer to the enumeration
+    // weakly, so that it does not own itself.
+    template<class T>
+    struct SelfNode : EnumNode<T>
+    {
+        explicit SelfNode(std::weak_ptr<const RecursiveNode<T>> self) :
+            self(std::move(self))
+        {
+        }
+
+        std::size_t count(std::size_t size) const override
+        {
+            return lock()->count(size);
+        }
+
+        T at(std::size_t size, std::size_t index) const override
+        {
+            return lock()->at(size, index);
+        }
+
+        std::shared_ptr<const RecursiveNode<T>> lock() const
+        {
+            std::shared_ptr<const RecursiveNode<T>> ret = self.lock();
+            if (!ret) {
+                throw std::logic_error(
+                    "enumRecursive: the enumeration no longer exists");
+            }
+            return ret;
+        }
+
+        const std::weak_ptr<const RecursiveNode<T>> self;
+    };
+
+    // size n holds n (and -n, if signed)
+    template<class Integral>
+    struct IntegerNode : EnumNode<Integral>
+    {
+        std::size_t count(std::size_t size) const override
+        {
+            if (size > std::uintmax_t(std::numeric_limits<Integral>::max()))
+                return 0;
+            return size == 0 || !std::numeric_limits<Integral>::is_signed ?
+                   1 : 2;
+        }
+
+        Integral at(std::size_t size, std::size_t index) const override
+        {
+            return index == 0 ? Integral(size) : Integral(-Integral(size));
+        }
+    };
+}
+
+/// The value x, of size 0.
+template<class T>
+Enumeration<T> enumSingleton(T x)
+{
+    return Enumeration<T>(
+        std::make_shared<const detail::SingletonNode<T>>(std::move(x)));
+}
+
+/// The values of a followed by those of b.
+template<class T>
+Enumeration<T> enumUnion(const Enumeration<T> &a, const Enumeration<T> &b)
+{
+    return Enumeration<T>(std::make_shared<const detail::UnionNode<T>>(a, b));
+}
+
+/// All pairs of values of a and b; the size of a pair is the sum of the
+/// sizes of its values.
+template<class A, class B>
+Enumeration<std::pair<A, B>> enumProduct(const Enumeration<A> &a,
+                                         const Enumeration<B> &b)
+{
+    return Enumeration<std::pair<A, B>>(
+        std::make_shared<const detail::ProductNode<A, B>>(a, b));
+}
+
+/// The values of e, each one size larger.
+template<class T>
+Enumeration<T> enumPay(const Enumeration<T> &e)
+{
+    return Enumeration<T>(std::make_shared<const detail::PayNode<T>>(e));
+}
+
+/// The values of e passed through f, which should be injective for the
+/// values to be counted correctly.
+template<class T, class U>
+Enumeration<T> enumMap(boost::function<T (U)> f, const Enumeration<U> &e)
+{
+    return Enumeration<T>(
+        std::make_shared<const detail::MapNode<T, U>>(std::move(f), e));
+}
+
+/// The enumeration returned by f, which is passed that same enumeration to
+/// define it recursively. f must only use it through enumPay, so that the
+/// values of a size only depend on those of smaller sizes. The recursive
+/// uses stop working once the returned enumeration and its copies are gone.
+template<class T>
+Enumeration<T> enumRecursive(
+        boost::function<Enumeration<T> (const Enumeration<T> &)> f)
+{
+    const std::shared_ptr<detail::RecursiveNode<T>> node =
+        std::make_shared<detail::RecursiveNode<T>>();
+    const Enumeration<T> self(
+        std::make_shared<const detail::SelfNode<T>>(node));
+    node->body = f(self).node();
+    return Enumeration<T>(node);
+}
+
+/// false and true, both of size 0.
+inline Enumeration<bool> enumBools()
+{
+    return enumUnion(enumSingleton(false), enumSingleton(true));
+}
+
+/// The integers, each of the size of its absolute value.
+template<class Integral>
+Enumeration<Integral> enumIntegers()
+{
+    return Enumeration<Integral>(
+        std::make_shared<const detail::IntegerNode<Integral>>());
+}
+
+namespace detail {
+    template<class T>
+    std::vector<T> cons(std::pair<T, std::vector<T>> p)
+    {
+        p.second.insert(p.second.begin(), std::move(p.first));
+        return std::move(p.second);
+    }
+}
+
+/// The vectors of values of e, of the size of their length plus the sizes
+/// of their elements.
+template<class T>
+Enumeration<std::vector<T>> enumListsOf(const Enumeration<T> &e)
+{
+    typedef std::vector<T> List;
+    return enumRecursive<List>([e](const Enumeration<List> &lists) {
+        return enumUnion(enumSingleton(List()),
+            enumPay(enumMap<List, std::pair<T, List>>(detail::cons<T>,
+                                                      enumProduct(e, lists))));
+    });
+}
+
+namespace detail {
+    template<class T>
+    class UniformGenerator
+    {
+        public:
+            explicit UniformGenerator(const Enumeration<T> &e) : m_enum(e)
+            {
+            }
+
+            T unGen(RngEngine &rng, std::size_t size) const
+            {
+                const std::size_t s = indexableSize(size);
+                return m_enum.at(s, uniformInt<std::size_t>(rng, 0,
+                                 m_enum.count(s) - 1));
+            }
+
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size) const
+            {
+                const std::size_t s = indexableSize(size);
+                const std::size_t index = uniformInt<std::size_t>(rng, 0,
+                    m_enum.count(s) - 1);
+                return ShrinkTree<T>(m_enum.at(s, index),
+                    makeExpand<T>(Smaller{m_enum, s, index}));
+            }
+
+            // A value does not know its size and index, so it only shrinks
+            // through its tree.
+            std::vector<T> shrink(const T &) const
+            {
+                return std::vector<T>();
+            }
+
+            // the values of all sizes up to the depth, the smaller first
+            std::size_t enumSize(std::size_t depth) const
+            {
+                std::size_t ret = 0;
+                for (std::size_t s = 0; s <= depth; ++s)
+                    ret = saturatingAdd(ret, m_enum.count(s));
+                return ret;
+            }
+
+            T enumAt(std::size_t index, std::size_t) const
+            {
+                for (std::size_t s = 0; ; ++s) {
+                    const std::size_t n = m_enum.count(s);
+                    if (index < n)
+                        return m_enum.at(s, index);
+                    index -= n;
+                }
+            }
+
+        private:
+            // the largest size up to the given one with values to index
+            std::size_t indexableSize(std::size_t size) const
+            {
+                for (std::size_t s = size + 1; s-- > 0; ) {
+                    const std::size_t n = m_enum.count(s);
+                    if (n != 0 && n != std::numeric_limits<std::size_t>::max())
+                        return s;
+                }
+                throw std::runtime_error("uniformOf: no values up to size");
+            }
+
+            // the first value of each smaller size, then values of the same
+            // size with smaller indices
+            struct Smaller
+            {
+                std::vector<ShrinkTree<T>> operator()(const T &,
+                        const typename ShrinkTree<T>::Expand &) const
+                {
+                    std::vector<ShrinkTree<T>> ret;
+                    for (std::size_t s = 0; s < size; ++s) {
+                        if (e.count(s) != 0)
+                            ret.push_back(tree(s, 0));
+                    }
+                    for (std::size_t n = index; n != 0; n /= 2)
+                        ret.push_back(tree(size, index - n));
+                    return ret;
+                }
+
+                ShrinkTree<T> tree(std::size_t s, std::size_t i) const
+                {
+                    return ShrinkTree<T>(e.at(s, i),
+                                         makeExpand<T>(Smaller{e, s, i}));
+                }
+
+                Enumeration<T> e;
+                std::size_t size;
+                std::size_t index;
+            };
+
+            const Enumeration<T> m_enum;
+    };
+}
+
+/// Generates values of the enumeration uniformly among those of the size
+/// parameter, or of the largest smaller size with values whose count fits
+/// into std::size_t. Shrinks to values of smaller sizes, then to those of
+/// the same size with smaller indices. Its values are enumerable (see
+/// quickCheckExhaustive) up to a depth, which is the largest size.
+template<class T>
+StatelessGenerator<T> uniformOf(const Enumeration<T> &e)
+{
+    return detail::UniformGenerator<T>(e);
+}
+
+}
+
+#endif
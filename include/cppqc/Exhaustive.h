@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_EXHAUSTIVE_H
+#define CPPQC_EXHAUSTIVE_H
+
+#include "Arbitrary.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Exhaustive checking in the style of SmallCheck: instead of sampling
+// random inputs, the runner checks every input up to a depth, which is a
+// proof of the property for all of them. This suits small domains, e.g.
+// properties of a few bools, and finds the smallest counterexamples first.
+// The generators of the property must enumerate their values (see enumSize
+// in Generator.h).
+
+namespace cppqc {
+
+namespace detail {
+    // Checks the inputs from the shared position "next" on, in chunks,
+    // until all are checked or one fails. "firstFailure" is the lowest
+    // failing index found by any thread, so no thread checks inputs after
+    // it, and the same counterexample is found with any number of threads.
+    template<class T0, class T1, class T2, class T3, class T4>
+    void checkEnumeration(const Property<T0, T1, T2, T3, T4> &prop,
+            std::size_t depth, std::size_t count,
+            std::atomic<std::size_t> &next,
+            std::atomic<std::size_t> &firstFailure)
+    {
+        const std::size_t chunk = 64;
+        for (;;) {
+            const std::size_t begin = next.fetch_add(chunk);
+            if (begin >= std::min(count, firstFailure.load()))
+                return;
+            const std::size_t end = count - begin < chunk ? count :
+                                                            begin + chunk;
+            for (std::size_t i = begin; i != end; ++i) {
+                if (i >= firstFailure.load())
+                    return;
+                bool success = false;
+                try {
+                    success = prop.checkInput(prop.enumInput(i, depth));
+                } catch (...) {
+                }
+                if (!success) {
+                    std::size_t failure = firstFailure.load();
+                    while (i < failure &&
+                           !firstFailure.compare_exchange_weak(failure, i)) {
+                    }
+                    return;
+                }
+            }
+        }
+    }
+}
+
+/// Checks the property on every input up to the given depth, on numThreads
+/// threads (all hardware threads if 0), and stops at the first
+/// counterexample in the order of the enumeration. The check function must
+/// be safe to call from several threads at once unless numThreads is 1.
+/// The events of the run go to the reporter, as in quickCheckReport.
+///
+/// Result::numTests is the number of inputs up to the counterexample, or of
+/// all inputs if the property holds; on failure, failedTestCase.index is
+/// the index of the counterexample in the enumeration and usedSize the
+/// depth, and failedTestCase.reproduction says so (the input is not
+/// generated from a seed). Throws NotEnumerable if a generator cannot
+/// enumerate its values, and std::overflow_error if there are too many
+/// inputs to count.
+template<class T0, class T1, class T2, class T3, class T4, class Reporter>
+Result quickCheckExhaustiveReport(const Property<T0, T1, T2, T3, T4> &prop,
+        Reporter &reporter, std::size_t depth = 5,
+        std::size_t numThreads = 0)
+{
+    const std::size_t count = prop.enumInputSize(depth);
+    if (count == std::numeric_limits<std::size_t>::max()) {
+        throw std::overflow_error(
+            "quickCheckExhaustive: too many inputs at this depth");
+    }
+    reporter.start(prop);
+
+    if (numThreads == 0)
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    numThreads = std::max<std::size_t>(std::min(numThreads, count / 64), 1);
+
+    std::atomic<std::size_t> next(0);
+    std::atomic<std::size_t> firstFailure(count);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < numThreads; ++i) {
+        threads.emplace_back([&] {
+            detail::checkEnumeration(prop, depth, count, next, firstFailure);
+        });
+    }
+    detail::checkEnumeration(prop, depth, count, next, firstFailure);
+    for (std::thread &t : threads)
+        t.join();
+
+    Result ret = detail::resultOf(detail::RunState(), QC_SUCCESS, count);
+    const std::size_t failure = firstFailure.load();
+    if (failure == count) {
+        if (!prop.expect())
+            ret.result = QC_NO_EXPECTED_FAILURE;
+        reporter.passed(prop, 0, ret);
+        return ret;
+    }
+
+    ret.result = prop.expect() ? QC_FAILURE : QC_SUCCESS;
+    ret.numTests = failure + 1;
+    ret.numShrinks = 0;
+    ret.numShrinkEvaluations = 0;
+    ret.usedSize = depth;
+    ret.failedTestCase.seed = 0;
+    ret.failedTestCase.index = failure;
+    ret.failedTestCase.size = depth;
+    std::ostringstream reproduction;
+    reproduction << "quickCheckExhaustive up to depth " << depth
+                 << "; the input has index " << failure
+                 << " in the enumeration";
+    ret.failedTestCase.reproduction = reproduction.str();
+    reporter.failed(prop, ret.numTests, 0, prop.enumInput(failure, depth),
+                    ret.failedTestCase);
+    return ret;
+}
+
+/// quickCheckExhaustiveReport with the report written to a stream.
+template<class T0, class T1, class T2, class T3, class T4>
+Result quickCheckExhaustive(const Property<T0, T1, T2, T3, T4> &prop,
+        std::ostream &out = std::cout, std::size_t depth = 5,
+        std::size_t numThreads = 0)
+{
+    StreamReporter reporter(out);
+    return quickCheckExhaustiveReport(prop, reporter, depth, numThreads);
+}
+
+}
+
+#endif
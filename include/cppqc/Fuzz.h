@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_FUZZ_H
+#define CPPQC_FUZZ_H
+
+#include "Test.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+
+// Runs a property under a coverage-guided fuzzer such as libFuzzer or
+// AFL++. The fuzzer's data replaces the random number engine: it is read
+// as the generation size followed by the choices the generator draws
+// (see RngEngine::replay), so every generator works unchanged and
+// mutations of the data turn into changes of the generated input. Data
+// that runs out is continued with zero choices, so short data (e.g., the
+// first inputs of a new corpus) generates small inputs instead of being
+// rejected.
+//
+// A fuzz target is a file with
+//
+//     #include "cppqc.h"
+//     #include "cppqc/Fuzz.h"
+//
+//     struct PropTestSort : cppqc::Property<std::vector<int>> { ... };
+//
+//     CPPQC_FUZZ_PROPERTY(PropTestSort)
+//
+// built with "clang++ -fsanitize=fuzzer" (or afl-clang-fast++ and
+// -fsanitize=fuzzer for AFL++). When a check fails, the input is printed
+// and the target aborts, so the fuzzer saves the data as a crash file. To
+// shrink it, check the property as usual, e.g. with quickCheckOutput, with
+// CPPQUICKCHECK_FUZZ_INPUT set to the path of the crash file. The maximum
+// size passed there must match the one of the fuzz target (100 by
+// default).
+
+namespace cppqc {
+
+enum FuzzOutcome
+{
+    FUZZ_PASSED,   // the check passed
+    FUZZ_REJECTED, // no input could be generated from the data
+    FUZZ_FAILED    // the check failed
+};
+
+/// Checks the property on the input generated from a fuzzer's data, and
+/// prints the input if the check fails.
+template<class T0, class T1, class T2, class T3, class T4>
+FuzzOutcome fuzzCheck(const Property<T0, T1, T2, T3, T4> &prop,
+        const std::uint8_t *data, std::size_t n, std::size_t maxSize = 100,
+        std::ostream &out = std::cerr)
+{
+    typedef typename Property<T0, T1, T2, T3, T4>::Input Input;
+
+    std::size_t size;
+    Choices choices;
+    detail::decodeFuzzInput(data, n, maxSize, size, choices);
+    RngEngine rng;
+    rng.replay(&choices, REPLAY_ZEROS);
+    std::vector<Input> in;
+    try {
+        in.push_back(prop.generateInput(rng, size));
+    } catch (...) {
+        return FUZZ_REJECTED;
+    }
+
+    bool success = false;
+    try {
+        success = prop.checkInput(in[0]);
+    } catch (...) {
+        out << "Caught an exception during testing.\n";
+    }
+    if (success || !prop.expect())
+        return FUZZ_PASSED;
+
+    out << "Falsifiable while fuzzing " << prop.name()
+        << ", for input:\n";
+    printInput(out, in[0]);
+    out << "To shrink it, check the property with "
+        << CPPQUICKCHECK_FUZZ_INPUT_ENV << "=<crash file>" << std::endl;
+    return FUZZ_FAILED;
+}
+
+/// The body of LLVMFuzzerTestOneInput: aborts if the check fails, and
+/// tells the fuzzer to not keep data that generates no input.
+template<class T0, class T1, class T2, class T3, class T4>
+int fuzzOne(const Property<T0, T1, T2, T3, T4> &prop,
+        const std::uint8_t *data, std::size_t n, std::size_t maxSize = 100)
+{
+    switch (fuzzCheck(prop, data, n, maxSize)) {
+        case FUZZ_FAILED:
+            std::abort();
+        case FUZZ_REJECTED:
+            return -1;
+        default:
+            return 0;
+    }
+}
+
+}
+
+/// Defines the fuzzer entry point LLVMFuzzerTestOneInput for a property
+/// class with a default constructor.
+#define CPPQC_FUZZ_PROPERTY(Prop) \
+    extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data, \
+                                          std::size_t size) \
+    { \
+        static const Prop prop; \
+        return cppqc::fuzzOne(prop, data, size); \
+    }
+
+#endif
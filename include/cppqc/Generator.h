@@ -26,21 +26,264 @@
 #ifndef CPPQC_GEN_H
 #define CPPQC_GEN_H
 
+#include "ShrinkTree.h"
+
 #include <boost/function.hpp>
-#include <boost/random/uniform_int.hpp>
+#include <array>
+#include <atomic>
 #include <tuple>
 #include <utility>
+#include <cassert>
 #include <cstddef>
-#include <iosfwd>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <ostream>
 #include <vector>
 #include <map>
 #include <algorithm>
 #include <stdexcept>
 #include <random>
+#include <type_traits>
 
 namespace cppqc {
 
-typedef std::mt19937 RngEngine;
+/// The random numbers drawn by a generator, in the order it drew them.
+typedef std::vector<std::uint32_t> Choices;
+
+/// Thrown by an RngEngine that replays choices when a generator draws more
+/// numbers than were recorded.
+struct ChoicesExhausted : std::runtime_error
+{
+    ChoicesExhausted() :
+        std::runtime_error("RngEngine: all replayed choices were drawn")
+    {
+    }
+};
+
+/// Thrown when a value is requested by its quantile (see quantile) from a
+/// generator that has none.
+struct NoQuantile : std::logic_error
+{
+    NoQuantile() :
+        std::logic_error("generator cannot map quantiles to values")
+    {
+    }
+};
+
+/// Thrown when the values of a generator are enumerated (see enumSize) but
+/// the generator cannot enumerate them.
+struct NotEnumerable : std::logic_error
+{
+    NotEnumerable() :
+        std::logic_error("generator cannot enumerate its values")
+    {
+    }
+};
+
+/// What an RngEngine that replays choices draws once they are used up.
+enum ReplayEnd
+{
+    REPLAY_EXHAUSTS, // throw ChoicesExhausted
+    REPLAY_RANDOM,   // draw random numbers
+    REPLAY_ZEROS     // draw zeros, the smallest choice
+};
+
+/// The random number engine passed to generators. It draws the numbers of
+/// std::mt19937, but can also record every number drawn as Choices, or
+/// draw recorded choices instead (see ChoiceShrink.h).
+class RngEngine
+{
+    public:
+        typedef std::mt19937::result_type result_type;
+
+        static constexpr result_type min()
+        {
+            return 0;
+        }
+
+        static constexpr result_type max()
+        {
+            return 0xffffffffu;
+        }
+
+        explicit RngEngine(result_type seed = std::mt19937::default_seed) :
+            m_engine(seed), m_record(nullptr), m_replay(nullptr), m_pos(0),
+            m_end(REPLAY_EXHAUSTS), m_testCase(nextTestCase()),
+            m_hasTestCaseSeed(false), m_testCaseSeed(0),
+            m_numDimensions(0), m_hasRunPosition(false), m_runSeed(0),
+            m_runIndex(0)
+        {
+        }
+
+        template<class SeedSeq, class = typename std::enable_if<
+            !std::is_convertible<SeedSeq, result_type>::value>::type>
+        explicit RngEngine(SeedSeq &seq) :
+            m_engine(seq), m_record(nullptr), m_replay(nullptr), m_pos(0),
+            m_end(REPLAY_EXHAUSTS), m_testCase(nextTestCase()),
+            m_hasTestCaseSeed(false), m_testCaseSeed(0),
+            m_numDimensions(0), m_hasRunPosition(false), m_runSeed(0),
+            m_runIndex(0)
+        {
+        }
+
+        result_type operator()()
+        {
+            if (m_record == nullptr && m_replay == nullptr)
+                return m_engine();
+            return nextChoice();
+        }
+
+        /// Appends every number drawn from now on to choices; stops
+        /// recording if choices is null.
+        void record(Choices *choices)
+        {
+            m_record = choices;
+        }
+
+        /// Draws the given choices from now on instead of random numbers,
+        /// and continues as "end" says once they are used up. Draws random
+        /// numbers again if choices is null.
+        void replay(const Choices *choices, ReplayEnd end = REPLAY_EXHAUSTS)
+        {
+            m_replay = choices;
+            m_pos = 0;
+            m_end = end;
+            m_hasRunPosition = false;
+            startTestCase();
+        }
+
+        /// Identifies the test case the engine generates, for caching
+        /// decisions made per test case; it is unique among all engines.
+        std::uint64_t testCase() const
+        {
+            return m_testCase;
+        }
+
+        /// A random number that stays the same for the whole test case,
+        /// for decisions that must not change between the generators of
+        /// one test case, even if they are built anew for every value
+        /// (see swarmTesting). It is drawn (as two choices) the first time
+        /// it is asked for in the test case.
+        std::uint64_t testCaseSeed()
+        {
+            if (!m_hasTestCaseSeed) {
+                const std::uint64_t hi = (*this)();
+                m_testCaseSeed = (hi << 32) | (*this)();
+                m_hasTestCaseSeed = true;
+            }
+            return m_testCaseSeed;
+        }
+
+        /// Starts a new test case with the same engine. Constructing an
+        /// engine or calling replay does so too.
+        void startTestCase()
+        {
+            m_testCase = nextTestCase();
+            m_hasTestCaseSeed = false;
+            m_numDimensions = 0;
+        }
+
+        /// Returns the first of n dimensions of the quasi-random sequence
+        /// that no generator of the test case has taken yet, and takes
+        /// them (see quasiRandom).
+        std::size_t takeDimensions(std::size_t n)
+        {
+            const std::size_t first = m_numDimensions;
+            m_numDimensions += n;
+            return first;
+        }
+
+        /// Sets the seed of the run the test case belongs to and the index
+        /// of the test case in it, for generators that spread their values
+        /// over a run (see quasiRandom). Cleared by replay, as replayed
+        /// choices determine the value on their own.
+        void setRunPosition(std::uint64_t seed, std::size_t index)
+        {
+            m_hasRunPosition = true;
+            m_runSeed = seed;
+            m_runIndex = index;
+        }
+
+        bool hasRunPosition() const
+        {
+            return m_hasRunPosition;
+        }
+
+        std::uint64_t runSeed() const
+        {
+            return m_runSeed;
+        }
+
+        std::size_t runIndex() const
+        {
+            return m_runIndex;
+        }
+
+        /// Draws the given number instead of a random one, for generators
+        /// that compute a choice themselves (see quasiRandom): it is
+        /// recorded like a drawn number, but replaced by the next choice if
+        /// choices are replayed.
+        result_type drawGiven(result_type value)
+        {
+            if (m_replay != nullptr)
+                return (*this)();
+            if (m_record != nullptr)
+                m_record->push_back(value);
+            return value;
+        }
+
+        /// Whether the engine replays choices.
+        bool replaying() const
+        {
+            return m_replay != nullptr;
+        }
+
+        /// The number of choices drawn since replay was called.
+        std::size_t numReplayed() const
+        {
+            return m_pos;
+        }
+
+    private:
+        static std::uint64_t nextTestCase()
+        {
+            static std::atomic<std::uint64_t> next(1);
+            return next++;
+        }
+
+        result_type nextChoice()
+        {
+            result_type ret;
+            if (m_replay == nullptr) {
+                ret = m_engine();
+            } else if (m_pos < m_replay->size()) {
+                ret = (*m_replay)[m_pos++];
+            } else if (m_end == REPLAY_RANDOM) {
+                ret = m_engine();
+            } else if (m_end == REPLAY_ZEROS) {
+                ret = 0;
+            } else {
+                throw ChoicesExhausted();
+            }
+            if (m_record != nullptr)
+                m_record->push_back(static_cast<std::uint32_t>(ret));
+            return ret;
+        }
+
+        std::mt19937 m_engine;
+        Choices *m_record;
+        const Choices *m_replay;
+        std::size_t m_pos;
+        ReplayEnd m_end;
+        std::uint64_t m_testCase;
+        bool m_hasTestCaseSeed;
+        std::uint64_t m_testCaseSeed;
+        std::size_t m_numDimensions;
+        bool m_hasRunPosition;
+        std::uint64_t m_runSeed;
+        std::size_t m_runIndex;
+};
 
 template<class T> struct Arbitrary;
 
@@ -68,6 +311,40 @@ template<class T> struct Arbitrary;
  * StatelessGeneratorConcept<T> (also models GeneratorConcept<T>):
  *      T unGen(RngEngine &, std::size_t) const;
  *      std::vector<T> shrink(const T &) const;
+ *
+ * Either kind of generator may also have a member function
+ *
+ *      ShrinkTree<T> unGenTree(RngEngine &, std::size_t);
+ *
+ * which generates a value together with the tree of its shrinks (see
+ * ShrinkTree.h). The runner shrinks failing inputs along these trees, which
+ * lets combinators such as convert, combine and suchThat shrink the values
+ * they were built from without remembering them. For generators without
+ * unGenTree, the tree is built by calling shrink. A tree may refer to the
+ * generator that made it, so it must not outlive it, and for a stateful
+ * generator without unGenTree it is only valid until the next call of unGen.
+ *
+ * A generator may also enumerate its values in the style of SmallCheck, with
+ * the member functions
+ *
+ *      std::size_t enumSize(std::size_t depth);
+ *      T enumAt(std::size_t index, std::size_t depth);
+ *
+ * enumSize returns the number of values up to the given depth, and enumAt
+ * returns one of them for each index below that number, the simplest
+ * first. The depth bounds the values like the size parameter bounds the
+ * generated ones: integers up to the depth, lists up to that length, and so
+ * on. Sizes that do not fit into std::size_t are returned as its maximum.
+ * For generators without these functions, both throw NotEnumerable. See
+ * quickCheckExhaustive in Exhaustive.h.
+ *
+ * Generators of numbers may also map quantiles to values, with
+ *
+ *      T quantile(double u, std::size_t size);
+ *
+ * which returns the value below which a fraction u (in [0, 1)) of the
+ * values drawn by unGen at that size lie. tupleOf uses it to spread the
+ * values of a run evenly over the space of its elements (see quasiRandom).
  */
 
 
@@ -80,7 +357,12 @@ namespace detail {
         {
         }
         virtual T unGen(RngEngine &, std::size_t) = 0;
+        virtual ShrinkTree<T> unGenTree(RngEngine &, std::size_t) = 0;
         virtual std::vector<T> shrink(const T &) = 0;
+        virtual std::size_t enumSize(std::size_t) = 0;
+        virtual T enumAt(std::size_t, std::size_t) = 0;
+        virtual bool hasQuantile() = 0;
+        virtual ShrinkTree<T> quantileTree(double, std::size_t) = 0;
         virtual GenConcept *clone() const = 0;
     };
 
@@ -91,11 +373,571 @@ namespace detail {
         {
         }
         virtual T unGen(RngEngine &, std::size_t) override = 0;
+        virtual ShrinkTree<T> unGenTree(RngEngine &, std::size_t) override = 0;
         virtual std::vector<T> shrink(const T &) override = 0;
+        virtual std::size_t enumSize(std::size_t) override = 0;
+        virtual T enumAt(std::size_t, std::size_t) override = 0;
+        virtual bool hasQuantile() override = 0;
+        virtual ShrinkTree<T> quantileTree(double, std::size_t) override = 0;
         virtual StatelessGenConcept *clone() const override = 0;
     };
 }
 
+namespace detail {
+
+    // compile-time list of tuple indices (std::index_sequence is C++14)
+    template<std::size_t... I>
+    struct IndexList {};
+
+    template<std::size_t N, std::size_t... I>
+    struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+
+    template<std::size_t... I>
+    struct MakeIndexList<0, I...>
+    {
+        typedef IndexList<I...> type;
+    };
+
+    static_assert(RngEngine::min() == 0 && RngEngine::max() == 0xffffffffu,
+                  "UniformIntSampler expects a 32-bit random engine");
+
+    inline std::uint32_t next32(RngEngine &rng)
+    {
+        return static_cast<std::uint32_t>(rng());
+    }
+
+    inline std::uint64_t next64(RngEngine &rng)
+    {
+        const std::uint64_t hi = next32(rng);
+        return (hi << 32) | next32(rng);
+    }
+
+    // Full 64x64 -> 128 bit multiplication, returns the upper 64 bits and
+    // stores the lower 64 bits in "lo".
+    inline std::uint64_t mulhi64(std::uint64_t a, std::uint64_t b,
+                                 std::uint64_t &lo)
+    {
+        const std::uint64_t aLo = a & 0xffffffffu, aHi = a >> 32;
+        const std::uint64_t bLo = b & 0xffffffffu, bHi = b >> 32;
+        const std::uint64_t ll = aLo * bLo;
+        const std::uint64_t lh = aLo * bHi;
+        const std::uint64_t hl = aHi * bLo;
+        const std::uint64_t hh = aHi * bHi;
+        const std::uint64_t mid = (ll >> 32) + (lh & 0xffffffffu) +
+                                  (hl & 0xffffffffu);
+        lo = (mid << 32) | (ll & 0xffffffffu);
+        return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    }
+
+    /// Draws integers uniformly from the closed range [min, max] using
+    /// Lemire's nearly divisionless method ("Fast Random Integer Generation
+    /// in an Interval", 2019).
+    ///
+    /// The rejection threshold is computed once when the sampler is
+    /// constructed, so a draw costs a single multiplication and no division.
+    /// The constructor is constexpr, so samplers with constant bounds are
+    /// built at compile time.
+    template<class Integer>
+    class UniformIntSampler
+    {
+        public:
+            constexpr UniformIntSampler(Integer min, Integer max) :
+                m_min(static_cast<std::uint64_t>(min)),
+                m_range(rangeOf(min, max)),
+                m_threshold(thresholdOf(rangeOf(min, max)))
+            {
+            }
+
+            Integer operator()(RngEngine &rng) const
+            {
+                return static_cast<Integer>(m_min + offset(rng));
+            }
+
+            Integer min() const
+            {
+                return static_cast<Integer>(m_min);
+            }
+
+            Integer max() const
+            {
+                return static_cast<Integer>(m_min + m_range - 1);
+            }
+
+        private:
+            // the number of values in [min, max], or 0 if the range
+            // covers all 2^64 values
+            static constexpr std::uint64_t rangeOf(Integer min, Integer max)
+            {
+                return static_cast<std::uint64_t>(max) -
+                       static_cast<std::uint64_t>(min) + 1;
+            }
+
+            // draws whose low bits are below the threshold are rejected:
+            // 2^32 mod range (or 2^64 mod range for ranges above 2^32).
+            // A draw of zero is kept all the same, so that zero choices
+            // (the smallest, see ChoiceShrink.h and REPLAY_ZEROS) always
+            // give the minimum instead of being rejected forever; that
+            // favours the minimum by one draw in 2^32.
+            static constexpr std::uint64_t thresholdOf(std::uint64_t range)
+            {
+                return range == 0 ? 0 :
+                       range <= 0x100000000ull ?
+                       (0x100000000ull - range) % range :
+                       (0 - range) % range;
+            }
+
+            std::uint64_t offset(RngEngine &rng) const
+            {
+                if (m_range == 0)
+                    return next64(rng);
+
+                if (m_range <= 0x100000000ull) {
+                    std::uint64_t m = std::uint64_t(next32(rng)) * m_range;
+                    while ((m & 0xffffffffu) < m_threshold && m != 0)
+                        m = std::uint64_t(next32(rng)) * m_range;
+                    return m >> 32;
+                }
+
+                std::uint64_t lo;
+                std::uint64_t hi = mulhi64(next64(rng), m_range, lo);
+                while (lo < m_threshold && (hi | lo) != 0)
+                    hi = mulhi64(next64(rng), m_range, lo);
+                return hi;
+            }
+
+            std::uint64_t m_min;
+            std::uint64_t m_range;
+            std::uint64_t m_threshold;
+    };
+
+    /// Convenience wrapper for one-off draws where the bounds are only known
+    /// at the call site (e.g., when they depend on the size parameter).
+    template<class Integer>
+    Integer uniformInt(RngEngine &rng, Integer min, Integer max)
+    {
+        return UniformIntSampler<Integer>(min, max)(rng);
+    }
+}
+
+// Bugs at the boundaries of integer types (overflow at the maximum, sign
+// errors at the minimum, off-by-one errors around powers of two) are all
+// but invisible to uniform or size-bounded draws. The integral Arbitrary
+// generators and choose therefore return an edge case instead of a
+// regular draw in edgeCasePercent() percent of the draws: the minimum or
+// maximum of their range or one of the two values next to it, or a power
+// of two, its negation, one of their neighbours or a value between two
+// powers of two, as long as it is in the range. Set it to 0 to get the
+// regular distributions only.
+constexpr const char* CPPQUICKCHECK_EDGE_CASES_ENV = "CPPQUICKCHECK_EDGE_CASES";
+
+namespace detail {
+    inline std::size_t defaultEdgeCasePercent()
+    {
+        const char *value = std::getenv(CPPQUICKCHECK_EDGE_CASES_ENV);
+        if (value == nullptr || *value == '\0')
+            return 10;
+        char *end = nullptr;
+        const unsigned long parsed = std::strtoul(value, &end, 10);
+        return *end == '\0' ? std::min<std::size_t>(parsed, 100) : 10;
+    }
+}
+
+/// The percentage of integral draws that are edge cases; defaults to the
+/// value of CPPQUICKCHECK_EDGE_CASES, or 10.
+inline std::size_t &edgeCasePercent()
+{
+    static std::size_t percent = detail::defaultEdgeCasePercent();
+    return percent;
+}
+
+namespace detail {
+    // Decides whether a value just drawn is replaced by an edge case. Draws
+    // nothing if edge cases are disabled, so that the regular draws stay
+    // the same, and otherwise compares a single choice to a threshold, so
+    // that every choice is a valid draw. Drawn after the regular value, so
+    // that lowering this choice or dropping the edge case's choices after
+    // it shrinks (see ChoiceShrink.h) to the regular value.
+    inline bool drawEdgeCase(RngEngine &rng)
+    {
+        const std::size_t percent = edgeCasePercent();
+        if (percent == 0)
+            return false;
+        const std::uint64_t threshold =
+            (std::uint64_t(1) << 32) * (100 - percent) / 100;
+        return next32(rng) >= threshold;
+    }
+
+    // |x|, also for the minimum of a signed type
+    inline std::uintmax_t magnitude(std::intmax_t x)
+    {
+        return x < 0 ? std::uintmax_t(0) - std::uintmax_t(x) :
+                       std::uintmax_t(x);
+    }
+
+    inline std::uintmax_t magnitude(std::uintmax_t x)
+    {
+        return x;
+    }
+
+    // Maps a single choice to an edge case, such that smaller choices give
+    // edge cases of smaller magnitude: half of the choices go to the powers
+    // of two 2^k, k < digits, each with a quarter for 2^k - 1, 2^k and
+    // 2^k + 1 and a quarter for the values between 2^(k-1) + 1 and 2^k - 1,
+    // then a quarter to the boundary of the range nearer to zero and the
+    // last quarter to the other boundary (each the boundary itself as
+    // often as both values next to it). Shrinking on the choices thus
+    // goes from the type's extremes down through all magnitudes to 0. The
+    // sign is drawn after, 0 for positive, even where it is not used, so
+    // that lowering the first choice never draws more choices.
+    template<class Integer>
+    Integer edgeCase(RngEngine &rng, Integer min, Integer max)
+    {
+        typedef std::numeric_limits<Integer> Limits;
+        typedef typename std::conditional<Limits::is_signed,
+            std::intmax_t, std::uintmax_t>::type Wide;
+        constexpr int digits = Limits::digits;
+
+        // the block of the choice, and its position within the block
+        const std::uint64_t scaled =
+            std::uint64_t(next32(rng)) * (2 * digits);
+        const int block = int(scaled >> 32);
+        const std::uint32_t frac = std::uint32_t(scaled);
+        const unsigned quarter = frac >> 30;
+        const bool negate = Limits::is_signed && (next32(rng) >> 31) != 0;
+
+        const std::uintmax_t span = static_cast<std::uintmax_t>(max) -
+                                    static_cast<std::uintmax_t>(min);
+        if (block >= digits) {
+            const unsigned offset = quarter == 0 ? 2 : quarter == 1 ? 1 : 0;
+            const std::uintmax_t inRange =
+                std::min<std::uintmax_t>(offset, span);
+            const Integer low =
+                Integer(static_cast<std::uintmax_t>(min) + inRange);
+            const Integer high =
+                Integer(static_cast<std::uintmax_t>(max) - inRange);
+            const bool nearer = block < digits + digits / 2;
+            const bool highNearer =
+                magnitude(Wide(high)) < magnitude(Wide(low));
+            return nearer == highNearer ? high : low;
+        }
+
+        const int k = block;
+        const unsigned offset = quarter == 0 ? 0 : quarter - 1;
+        Wide v;
+        if (quarter == 0 && k >= 3) {
+            // 2^(k-1) + 2 to 2^k - 2, spread over the quarter
+            const std::uint64_t count = (std::uint64_t(1) << (k - 1)) - 3;
+            std::uint64_t lo;
+            const std::uint64_t pos =
+                mulhi64(std::uint64_t(frac << 2) << 32, count, lo);
+            v = Wide((std::uint64_t(1) << (k - 1)) + 2 + pos);
+        } else {
+            // 2^k - 1, 2^k and 2^k + 1
+            v = Wide(Wide(Wide(1) << k) - 1 + Wide(offset));
+        }
+        if (negate)
+            v = Wide(0) - v;
+        if (v < Wide(min) || v > Wide(max))
+            return Integer(static_cast<std::uintmax_t>(min) +
+                           std::min<std::uintmax_t>(offset, span));
+        return Integer(v);
+    }
+}
+
+// In swarm testing, every oneof and frequency generator uses only a random
+// subset of its branches in each test case, about half of them and at
+// least one. The inputs of a run then differ in their mix of branches
+// rather than all being the same even mix, which reaches inputs that need
+// many instances of a rare branch. The subset depends only on the number
+// of branches and on a seed per test case (see RngEngine::testCaseSeed),
+// so generators built anew for every value (e.g., inside sized) keep
+// their subset for the whole test case, and the subsets are determined by
+// the seed of the run. Off by default; on if CPPQUICKCHECK_SWARM is set to
+// anything but 0.
+constexpr const char* CPPQUICKCHECK_SWARM_ENV = "CPPQUICKCHECK_SWARM";
+
+namespace detail {
+    // Whether the environment variable is set to anything but 0.
+    inline bool flagFromEnv(const char *name)
+    {
+        const char *value = std::getenv(name);
+        return value != nullptr && *value != '\0' &&
+               !(value[0] == '0' && value[1] == '\0');
+    }
+}
+
+/// Whether swarm testing is on; set it to switch it for all generators.
+inline bool &swarmTesting()
+{
+    static bool swarm = detail::flagFromEnv(CPPQUICKCHECK_SWARM_ENV);
+    return swarm;
+}
+
+// In quasi-random mode, tupleOf spreads the values of a run evenly over
+// the space of its elements, instead of drawing them independently, which
+// leaves gaps and clusters. The element generators must map quantiles to
+// values (see quantile, implemented by choose and the Arbitrary integral
+// and floating point types). Test case i then gets the quantiles of point
+// i + 1 of the Halton sequence, shifted by a random offset per element
+// that depends on the seed of the run (a Cranley-Patterson rotation), so
+// the values are determined by the seed and the index of the test case.
+// Every tuple of a test case takes dimensions of its own (see
+// RngEngine::takeDimensions), and the quantiles are drawn as choices, so
+// that replaying the choices (e.g., when shrinking on them) gives the
+// same values. Tuples with other elements, and values generated outside
+// of a run, are drawn as usual. Off by default; on if
+// CPPQUICKCHECK_QUASI_RANDOM is set to anything but 0.
+constexpr const char* CPPQUICKCHECK_QUASI_RANDOM_ENV =
+    "CPPQUICKCHECK_QUASI_RANDOM";
+
+/// Whether quasi-random mode is on; set it to switch it for all runs.
+inline bool &quasiRandom()
+{
+    static bool quasi = detail::flagFromEnv(CPPQUICKCHECK_QUASI_RANDOM_ENV);
+    return quasi;
+}
+
+namespace detail {
+    // Maps u in [0, 1) to an offset in [0, range), where a range of 0
+    // stands for all 2^64 offsets.
+    inline std::uint64_t scaleQuantile(double u, std::uint64_t range)
+    {
+        // 53 bits of u, exact as u < 1
+        const std::uint64_t x = std::uint64_t(u * 9007199254740992.0) << 11;
+        if (range == 0)
+            return x;
+        std::uint64_t lo;
+        return mulhi64(x, range, lo);
+    }
+
+    // Point index of the Halton sequence in the given dimension: the
+    // digits of index in the dimension's prime base, mirrored at the
+    // radix point.
+    inline double haltonPoint(std::size_t dimension, std::uint64_t index)
+    {
+        static const unsigned PRIMES[] = { 2, 3, 5, 7, 11, 13, 17, 19, 23,
+                                           29, 31, 37, 41, 43, 47, 53 };
+        const unsigned base =
+            PRIMES[dimension % (sizeof(PRIMES) / sizeof(PRIMES[0]))];
+        double point = 0, digitValue = 1.0 / base;
+        for (; index != 0; index /= base) {
+            point += double(index % base) * digitValue;
+            digitValue /= base;
+        }
+        return point;
+    }
+
+    // The shift of a dimension, uniform in [0, 1) (splitmix64).
+    inline double haltonShift(std::uint64_t seed, std::size_t dimension)
+    {
+        std::uint64_t z = seed + (dimension + 1) * 0x9e3779b97f4a7c15ULL;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z ^= z >> 31;
+        return double(z >> 11) / 9007199254740992.0;
+    }
+
+    // The quantile of a dimension for the test case of the engine, drawn
+    // as two choices, so that replaying them gives it again.
+    inline double quasiRandomQuantile(RngEngine &rng, std::size_t dimension)
+    {
+        double u = 0;
+        if (rng.hasRunPosition()) {
+            u = haltonPoint(dimension, std::uint64_t(rng.runIndex()) + 1) +
+                haltonShift(rng.runSeed(), dimension);
+            if (u >= 1)
+                u -= 1;
+        }
+        const std::uint64_t x = scaleQuantile(u, 0);
+        const std::uint64_t hi = rng.drawGiven(RngEngine::result_type(x >> 32));
+        const std::uint64_t lo = rng.drawGiven(RngEngine::result_type(x));
+        return double(((hi << 32) | lo) >> 11) / 9007199254740992.0;
+    }
+}
+
+namespace detail {
+    // splitmix64's finalizer: a well mixed 64-bit hash of z
+    inline std::uint64_t mix64(std::uint64_t z)
+    {
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // The branches of a oneof or frequency generator that are enabled in
+    // the current test case.
+    class SwarmBranches
+    {
+        public:
+            SwarmBranches() : m_testCase(0) {}
+
+            // Returns null if all of the n branches may be used.
+            const std::vector<bool> *enabled(RngEngine &rng, std::size_t n)
+            {
+                if (!swarmTesting() || n <= 1)
+                    return nullptr;
+                if (rng.testCase() == m_testCase && m_enabled.size() == n)
+                    return &m_enabled;
+
+                m_testCase = rng.testCase();
+                const std::uint64_t seed = rng.testCaseSeed();
+                m_enabled.assign(n, false);
+                // zero choices enable the first branch only, so that
+                // shrinking on the choices leads there
+                if (seed == 0) {
+                    m_enabled[0] = true;
+                    return &m_enabled;
+                }
+                bool any = false;
+                std::uint64_t bits = 0;
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (i % 64 == 0) {
+                        bits = mix64(seed +
+                            (n + i / 64) * 0x9e3779b97f4a7c15ULL);
+                    }
+                    m_enabled[i] = ((bits >> (i % 64)) & 1) != 0;
+                    any = any || m_enabled[i];
+                }
+                if (!any)
+                    m_enabled[mix64(seed ^ n) % n] = true;
+                return &m_enabled;
+            }
+
+        private:
+            std::uint64_t m_testCase;
+            std::vector<bool> m_enabled;
+    };
+}
+
+namespace detail {
+    template<class G>
+    struct HasUnGenTree
+    {
+    private:
+        template<class U>
+        static char test(decltype(std::declval<U &>().unGenTree(
+                std::declval<RngEngine &>(), std::size_t())) *);
+        template<class U>
+        static long test(...);
+    public:
+        static const bool value = sizeof(test<G>(nullptr)) == 1;
+    };
+
+    template<class T, class G>
+    struct ShrinkWith
+    {
+        std::vector<T> operator()(const T &x) const
+        {
+            return gen->shrink(x);
+        }
+
+        G *gen;
+    };
+
+    // Generates the tree of a model, or builds it from the model's shrink
+    // if it has no unGenTree.
+    template<class T, class G>
+    typename std::enable_if<HasUnGenTree<G>::value, ShrinkTree<T>>::type
+    unGenTreeOf(G &gen, RngEngine &rng, std::size_t size)
+    {
+        return gen.unGenTree(rng, size);
+    }
+
+    template<class T, class G>
+    typename std::enable_if<!HasUnGenTree<G>::value, ShrinkTree<T>>::type
+    unGenTreeOf(G &gen, RngEngine &rng, std::size_t size)
+    {
+        return unfoldShrinkTree<T>(gen.unGen(rng, size),
+                                   ShrinkWith<T, G>{&gen});
+    }
+}
+
+namespace detail {
+    template<class G>
+    struct HasEnumeration
+    {
+    private:
+        template<class U>
+        static char test(decltype(std::declval<U &>().enumSize(
+                std::size_t())) *);
+        template<class U>
+        static long test(...);
+    public:
+        static const bool value = sizeof(test<G>(nullptr)) == 1;
+    };
+
+    template<class G>
+    typename std::enable_if<HasEnumeration<G>::value, std::size_t>::type
+    enumSizeOf(G &gen, std::size_t depth)
+    {
+        return gen.enumSize(depth);
+    }
+
+    template<class G>
+    typename std::enable_if<!HasEnumeration<G>::value, std::size_t>::type
+    enumSizeOf(G &, std::size_t)
+    {
+        throw NotEnumerable();
+    }
+
+    template<class T, class G>
+    typename std::enable_if<HasEnumeration<G>::value, T>::type
+    enumAtOf(G &gen, std::size_t index, std::size_t depth)
+    {
+        return gen.enumAt(index, depth);
+    }
+
+    template<class T, class G>
+    typename std::enable_if<!HasEnumeration<G>::value, T>::type
+    enumAtOf(G &, std::size_t, std::size_t)
+    {
+        throw NotEnumerable();
+    }
+
+    template<class G>
+    struct HasQuantile
+    {
+    private:
+        template<class U>
+        static char test(decltype(std::declval<U &>().quantile(
+                double(), std::size_t())) *);
+        template<class U>
+        static long test(...);
+    public:
+        static const bool value = sizeof(test<G>(nullptr)) == 1;
+    };
+
+    // The value at the quantile with the tree of its shrinks, built from
+    // the model's shrink.
+    template<class T, class G>
+    typename std::enable_if<HasQuantile<G>::value, ShrinkTree<T>>::type
+    quantileTreeOf(G &gen, double u, std::size_t size)
+    {
+        return unfoldShrinkTree<T>(gen.quantile(u, size),
+                                   ShrinkWith<T, G>{&gen});
+    }
+
+    template<class T, class G>
+    typename std::enable_if<!HasQuantile<G>::value, ShrinkTree<T>>::type
+    quantileTreeOf(G &, double, std::size_t)
+    {
+        throw NoQuantile();
+    }
+
+    // Enumeration sizes saturate at the maximum of std::size_t.
+    inline std::size_t saturatingAdd(std::size_t a, std::size_t b)
+    {
+        const std::size_t max = std::numeric_limits<std::size_t>::max();
+        return a > max - b ? max : a + b;
+    }
+
+    inline std::size_t saturatingMul(std::size_t a, std::size_t b)
+    {
+        const std::size_t max = std::numeric_limits<std::size_t>::max();
+        return b != 0 && a > max / b ? max : a * b;
+    }
+}
+
 template<class T>
 class Generator;
 
@@ -125,27 +967,53 @@ class StatelessGenerator
             return *this;
         }
 
-        StatelessGenerator &operator=(const StatelessGenerator &g)
+        StatelessGenerator &operator=(const StatelessGenerator &g)
+        {
+            detail::StatelessGenConcept<T> *tmp = g.m_gen.clone();
+            delete m_gen;
+            m_gen = tmp;
+            return *this;
+        }
+
+        ~StatelessGenerator()
+        {
+            delete m_gen;
+        }
+
+        T unGen(RngEngine &rng, std::size_t size) const
+        {
+            return m_gen->unGen(rng, size);
+        }
+
+        ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size) const
+        {
+            return m_gen->unGenTree(rng, size);
+        }
+
+        std::vector<T> shrink(const T &x) const
+        {
+            return m_gen->shrink(x);
+        }
+
+        std::size_t enumSize(std::size_t depth) const
         {
-            detail::StatelessGenConcept<T> *tmp = g.m_gen.clone();
-            delete m_gen;
-            m_gen = tmp;
-            return *this;
+            return m_gen->enumSize(depth);
         }
 
-        ~StatelessGenerator()
+        T enumAt(std::size_t index, std::size_t depth) const
         {
-            delete m_gen;
+            return m_gen->enumAt(index, depth);
         }
 
-        T unGen(RngEngine &rng, std::size_t size) const
+        bool hasQuantile() const
         {
-            return m_gen->unGen(rng, size);
+            return m_gen->hasQuantile();
         }
 
-        std::vector<T> shrink(const T &x) const
+        // throws NoQuantile unless hasQuantile
+        ShrinkTree<T> quantileTree(double u, std::size_t size) const
         {
-            return m_gen->shrink(x);
+            return m_gen->quantileTree(u, size);
         }
 
     private:
@@ -167,6 +1035,11 @@ class StatelessGenerator
                     return m_obj.unGen(rng, size);
                 }
 
+                ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size)
+                {
+                    return detail::unGenTreeOf<T>(m_obj, rng, size);
+                }
+
                 std::vector<T> shrink(const T &x)
                 {
                     return m_obj.shrink(x);
@@ -177,6 +1050,27 @@ class StatelessGenerator
                     return m_obj.shrink(x);
                 }
 
+                std::size_t enumSize(std::size_t depth)
+                {
+                    return detail::enumSizeOf(m_obj, depth);
+                }
+
+                T enumAt(std::size_t index, std::size_t depth)
+                {
+                    return detail::enumAtOf<T>(m_obj, index, depth);
+                }
+
+                bool hasQuantile()
+                {
+                    return detail::HasQuantile<
+                        const StatelessGeneratorModel>::value;
+                }
+
+                ShrinkTree<T> quantileTree(double u, std::size_t size)
+                {
+                    return detail::quantileTreeOf<T>(m_obj, u, size);
+                }
+
                 detail::StatelessGenConcept<T> *clone() const
                 {
                     return new StatelessGenModel(m_obj);
@@ -246,11 +1140,37 @@ class Generator
             return m_gen->unGen(rng, size);
         }
 
+        ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size) const
+        {
+            return m_gen->unGenTree(rng, size);
+        }
+
         std::vector<T> shrink(const T &x) const
         {
             return m_gen->shrink(x);
         }
 
+        std::size_t enumSize(std::size_t depth) const
+        {
+            return m_gen->enumSize(depth);
+        }
+
+        T enumAt(std::size_t index, std::size_t depth) const
+        {
+            return m_gen->enumAt(index, depth);
+        }
+
+        bool hasQuantile() const
+        {
+            return m_gen->hasQuantile();
+        }
+
+        // throws NoQuantile unless hasQuantile
+        ShrinkTree<T> quantileTree(double u, std::size_t size) const
+        {
+            return m_gen->quantileTree(u, size);
+        }
+
     private:
         template<class GeneratorModel>
         class GenModel : public detail::GenConcept<T>
@@ -265,11 +1185,38 @@ class Generator
                     return m_obj.unGen(rng, size);
                 }
 
+                ShrinkTree<T> unGenTree(RngEngine &rng,
+                                        std::size_t size) override
+                {
+                    return detail::unGenTreeOf<T>(m_obj, rng, size);
+                }
+
                 std::vector<T> shrink(const T &x) override
                 {
                     return m_obj.shrink(x);
                 }
 
+                std::size_t enumSize(std::size_t depth) override
+                {
+                    return detail::enumSizeOf(m_obj, depth);
+                }
+
+                T enumAt(std::size_t index, std::size_t depth) override
+                {
+                    return detail::enumAtOf<T>(m_obj, index, depth);
+                }
+
+                bool hasQuantile() override
+                {
+                    return detail::HasQuantile<GeneratorModel>::value;
+                }
+
+                ShrinkTree<T> quantileTree(double u,
+                                           std::size_t size) override
+                {
+                    return detail::quantileTreeOf<T>(m_obj, u, size);
+                }
+
                 detail::GenConcept<T> *clone() const override
                 {
                     return new GenModel(m_obj);
@@ -296,8 +1243,10 @@ std::vector<T> sample(const Generator<T> &g, std::size_t num = 0,
     std::vector<T> ret;
     ret.reserve(num);
     try {
-        for (std::size_t i = 0; i < num; ++i)
+        for (std::size_t i = 0; i < num; ++i) {
+            rng.startTestCase();
             ret.push_back(g.unGen(rng, i));
+        }
     } catch (...) {
     }
     return ret;
@@ -318,6 +1267,7 @@ void sampleOutput(const Generator<T> &g,
         for (std::size_t i = 0; i < num; ++i) {
             if (i != 0)
                 out << ' ';
+            rng.startTestCase();
             out << g.unGen(rng, i);
         }
     } catch (...) {
@@ -340,8 +1290,12 @@ std::vector<std::pair<T, std::vector<T> > > sampleShrink(const Generator<T> &g,
     ret.reserve(num);
     try {
         for (std::size_t i = 0; i < num; ++i) {
-            T x = g.unGen(rng, i);
-            ret.push_back(std::make_pair(x, g.shrink(x)));
+            rng.startTestCase();
+            const ShrinkTree<T> tree = g.unGenTree(rng, i);
+            std::vector<T> shr;
+            for (ShrinkTree<T> &c : tree.children())
+                shr.push_back(std::move(c.value()));
+            ret.push_back(std::make_pair(tree.value(), std::move(shr)));
         }
     } catch (...) {
     }
@@ -361,8 +1315,12 @@ void sampleShrinkOutput(const Generator<T> &g, std::ostream &out,
     RngEngine rng(seed);
     try {
         for (std::size_t i = 0; i < num; ++i) {
-            T x = g.unGen(rng, i);
-            std::vector<T> shr = g.shrink(x);
+            rng.startTestCase();
+            const ShrinkTree<T> tree = g.unGenTree(rng, i);
+            const T &x = tree.value();
+            std::vector<T> shr;
+            for (ShrinkTree<T> &c : tree.children())
+                shr.push_back(std::move(c.value()));
             if (randomized)
                 std::random_shuffle(shr.begin(), shr.end());
             out << x << " ->";
@@ -411,18 +1369,18 @@ namespace detail {
             {
             }
 
-            T unGen(RngEngine &rng, std::size_t size)
+            T unGen(RngEngine &rng, std::size_t size) const
             {
                 return m_gen.unGen(rng, size);
             }
 
-            std::vector<T> shrink(const T &)
+            std::vector<T> shrink(const T &) const
             {
                 return std::vector<T>();
             }
 
         private:
-            StatelessGenerator<T> m_gen;
+            const StatelessGenerator<T> m_gen;
     };
 }
 
@@ -445,24 +1403,32 @@ namespace detail {
     {
         public:
             SizedGenerator(boost::function<Generator<T> (std::size_t)> f) :
-                m_genfun(f), m_lastgen(f(0))
+                m_genfun(f), m_lastgen(new Generator<T>(f(0)))
             {
             }
 
             T unGen(RngEngine &rng, std::size_t size)
             {
-                m_lastgen = m_genfun(size);
-                return m_lastgen.unGen(rng, size);
+                m_lastgen.reset(new Generator<T>(m_genfun(size)));
+                return m_lastgen->unGen(rng, size);
+            }
+
+            // the tree keeps the generator it came from alive
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size)
+            {
+                m_lastgen.reset(new Generator<T>(m_genfun(size)));
+                return retainShrinkTree(m_lastgen->unGenTree(rng, size),
+                                        m_lastgen);
             }
 
             std::vector<T> shrink(const T &x)
             {
-                return m_lastgen.shrink(x);
+                return m_lastgen->shrink(x);
             }
 
         private:
             const boost::function<Generator<T> (std::size_t)> m_genfun;
-            Generator<T> m_lastgen;
+            std::shared_ptr<const Generator<T>> m_lastgen;
     };
 }
 
@@ -489,6 +1455,11 @@ namespace detail {
                 return m_gen.unGen(rng, m_size);
             }
 
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t)
+            {
+                return m_gen.unGenTree(rng, m_size);
+            }
+
             std::vector<T> shrink(const T &x)
             {
                 return m_gen.shrink(x);
@@ -514,6 +1485,11 @@ namespace detail {
                 return m_gen.unGen(rng, m_size);
             }
 
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t) const
+            {
+                return m_gen.unGenTree(rng, m_size);
+            }
+
             std::vector<T> shrink(const T &x) const
             {
                 return m_gen.shrink(x);
@@ -545,15 +1521,15 @@ namespace detail {
     {
         public:
             ChooseStatelessGenerator(Integer min, Integer max) :
-                m_min(min), m_max(max)
+                m_min(min), m_max(max), m_sampler(min, max)
             {
                 assert(min <= max);
             }
 
             Integer unGen(RngEngine &rng, std::size_t) const
             {
-                boost::uniform_int<Integer> dist(m_min, m_max);
-                return dist(rng);
+                const Integer x = m_sampler(rng);
+                return drawEdgeCase(rng) ? edgeCase(rng, m_min, m_max) : x;
             }
 
             std::vector<Integer> shrink(Integer x) const
@@ -570,14 +1546,46 @@ namespace detail {
                 return ret;
             }
 
+            // the values up to depth away from the one shrunk towards,
+            // in the order of shrink
+            std::size_t enumSize(std::size_t depth) const
+            {
+                const std::uintmax_t span =
+                    static_cast<std::uintmax_t>(m_max) -
+                    static_cast<std::uintmax_t>(m_min);
+                return span < depth ? std::size_t(span) + 1 :
+                                      saturatingAdd(depth, 1);
+            }
+
+            Integer enumAt(std::size_t index, std::size_t) const
+            {
+                if (abs(m_min) <= abs(m_max)) {
+                    return Integer(static_cast<std::uintmax_t>(m_min) +
+                                   index);
+                }
+                return Integer(static_cast<std::uintmax_t>(m_max) - index);
+            }
+
+            // without edge cases
+            Integer quantile(double u, std::size_t) const
+            {
+                const std::uint64_t range =
+                    static_cast<std::uint64_t>(m_max) -
+                    static_cast<std::uint64_t>(m_min) + 1;
+                return Integer(static_cast<std::uint64_t>(m_min) +
+                               scaleQuantile(u, range));
+            }
+
         private:
             const Integer m_min;
             const Integer m_max;
+            const UniformIntSampler<Integer> m_sampler;
     };
 }
 
 /// Generates a random integer in the range min..max inclusive, requires that
-/// min <= max. Shrinks towards smaller absolute values.
+/// min <= max. Mixes in edge cases of the range (see edgeCasePercent).
+/// Shrinks towards smaller absolute values.
 template<class Integer>
 StatelessGenerator<Integer> choose(Integer min, Integer max)
 {
@@ -604,6 +1612,14 @@ namespace detail {
                 return ret;
             }
 
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size)
+            {
+                ShrinkTree<T> ret = m_gen.unGenTree(rng, size);
+                if (!m_pred(ret.value()))
+                    throw std::runtime_error("suchThat: generated value did not satisfy pred");
+                return filterShrinkTree(std::move(ret), m_pred);
+            }
+
             std::vector<T> shrink(const T &x)
             {
                 std::vector<T> ret = m_gen.shrink(x);
@@ -635,6 +1651,14 @@ namespace detail {
                 return ret;
             }
 
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size) const
+            {
+                ShrinkTree<T> ret = m_gen.unGenTree(rng, size);
+                if (!m_pred(ret.value()))
+                    throw std::runtime_error("suchThat: generated value did not satisfy pred");
+                return filterShrinkTree(std::move(ret), m_pred);
+            }
+
             std::vector<T> shrink(const T &x) const
             {
                 std::vector<T> ret = m_gen.shrink(x);
@@ -667,31 +1691,60 @@ namespace detail {
     class OneOfGenerator
     {
         public:
+            OneOfGenerator() : m_sampler(0, 0), m_last_index(0)
+            {
+            }
+
             OneOfGenerator &operator()(const Generator<T> &g)
             {
                 m_gens.push_back(g);
+                m_sampler = UniformIntSampler<std::size_t>(0, m_gens.size() - 1);
                 return *this;
             }
 
             T unGen(RngEngine &rng, std::size_t size)
             {
-                boost::uniform_int<std::size_t> dist(0, m_gens.size() - 1);
-                m_last_index = dist(rng);
+                m_last_index = pick(rng);
                 return m_gens[m_last_index].unGen(rng, size);
             }
 
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size)
+            {
+                m_last_index = pick(rng);
+                return m_gens[m_last_index].unGenTree(rng, size);
+            }
+
             std::vector<T> shrink(const T &x)
             {
                 return m_gens[m_last_index].shrink(x);
             }
 
         private:
+            std::size_t pick(RngEngine &rng)
+            {
+                const std::vector<bool> *enabled =
+                    m_swarm.enabled(rng, m_gens.size());
+                if (enabled == nullptr)
+                    return m_sampler(rng);
+                const std::size_t numEnabled =
+                    std::count(enabled->begin(), enabled->end(), true);
+                std::size_t k = uniformInt<std::size_t>(rng, 0,
+                                                        numEnabled - 1);
+                std::size_t i = 0;
+                while (!(*enabled)[i] || k-- != 0)
+                    ++i;
+                return i;
+            }
+
             std::vector<Generator<T> > m_gens;
+            UniformIntSampler<std::size_t> m_sampler;
             std::size_t m_last_index;
+            SwarmBranches m_swarm;
     };
 }
 
-/// Randomly uses one of the given generators.
+/// Randomly uses one of the given generators (see swarmTesting for using
+/// only some of them per test case).
 template<class T>
 detail::OneOfGenerator<T> oneof(const Generator<T> &g)
 {
@@ -705,7 +1758,7 @@ namespace detail {
     class FrequencyGenerator
     {
         public:
-            FrequencyGenerator() : m_tot(0)
+            FrequencyGenerator() : m_tot(0), m_sampler(1, 1), m_last_index(0)
             {
             }
 
@@ -715,16 +1768,15 @@ namespace detail {
                 if (weight != 0) {
                     m_tot += weight;
                     m_gens.insert(std::make_pair(m_tot, g));
+                    m_sampler = UniformIntSampler<std::size_t>(1, m_tot);
                 }
                 return *this;
             }
 
             T unGen(RngEngine &rng, std::size_t size)
             {
-                boost::uniform_int<std::size_t> dist(1, m_tot);
-                std::size_t weight = dist(rng);
                 typename std::map<std::size_t, Generator<T> >::iterator it =
-                    m_gens.lower_bound(weight);
+                    pick(rng);
                 if (it == m_gens.end()) {
                     throw std::logic_error("frequency: all generators have weight 0");
                 } else {
@@ -733,6 +1785,18 @@ namespace detail {
                 }
             }
 
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size)
+            {
+                typename std::map<std::size_t, Generator<T> >::iterator it =
+                    pick(rng);
+                if (it == m_gens.end()) {
+                    throw std::logic_error("frequency: all generators have weight 0");
+                } else {
+                    m_last_index = it->first;
+                    return it->second.unGenTree(rng, size);
+                }
+            }
+
             std::vector<T> shrink(const T &x)
             {
                 typename std::map<std::size_t, Generator<T> >::iterator it =
@@ -742,14 +1806,46 @@ namespace detail {
             }
 
         private:
+            // the generators are keyed by their cumulative weight
+            typename std::map<std::size_t, Generator<T> >::iterator
+            pick(RngEngine &rng)
+            {
+                const std::vector<bool> *enabled =
+                    m_swarm.enabled(rng, m_gens.size());
+                if (enabled == nullptr)
+                    return m_gens.lower_bound(m_sampler(rng));
+
+                std::size_t total = 0, previous = 0, i = 0;
+                for (const auto &g : m_gens) {
+                    if ((*enabled)[i++])
+                        total += g.first - previous;
+                    previous = g.first;
+                }
+                std::size_t weight = uniformInt<std::size_t>(rng, 1, total);
+                previous = 0;
+                i = 0;
+                for (auto it = m_gens.begin(); ; ++it) {
+                    const std::size_t w = it->first - previous;
+                    previous = it->first;
+                    if (!(*enabled)[i++])
+                        continue;
+                    if (weight <= w)
+                        return it;
+                    weight -= w;
+                }
+            }
+
             std::map<std::size_t, Generator<T> > m_gens;
             std::size_t m_tot;
+            UniformIntSampler<std::size_t> m_sampler;
             std::size_t m_last_index;
+            SwarmBranches m_swarm;
     };
 }
 
 /// Chooses one of the given generators, with a weighted random distribution.
-/// Any generator with weight "0" will not be chosen.
+/// Any generator with weight "0" will not be chosen. See swarmTesting for
+/// using only some of them per test case.
 template<class T>
 detail::FrequencyGenerator<T> frequency(std::size_t f, const Generator<T> &g)
 {
@@ -763,26 +1859,39 @@ namespace detail {
     class ElementsGenerator
     {
         public:
+            ElementsGenerator() : m_sampler(0, 0), m_last_index(0)
+            {
+            }
+
             ElementsGenerator &operator()(const std::initializer_list<T> x)
             {
                 for (auto &i: x)
                     m_elems.push_back(i);
+                m_sampler = UniformIntSampler<std::size_t>(0, m_elems.size() - 1);
                 return *this;
             }
 
             ElementsGenerator &operator()(const T &x)
             {
                 m_elems.push_back(x);
+                m_sampler = UniformIntSampler<std::size_t>(0, m_elems.size() - 1);
                 return *this;
             }
 
             T unGen(RngEngine &rng, std::size_t /*size*/)
             {
-                boost::uniform_int<std::size_t> dist(0, m_elems.size() - 1);
-                m_last_index = dist(rng);
+                m_last_index = m_sampler(rng);
                 return m_elems[m_last_index];
             }
 
+            // shrinks to the elements before the generated one
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t /*size*/)
+            {
+                m_last_index = m_sampler(rng);
+                return ShrinkTree<T>(m_elems[m_last_index], makeExpand<T>(
+                                     Earlier{&m_elems, m_last_index}));
+            }
+
             std::vector<T> shrink(const T &)
             {
                 std::vector<T> ret;
@@ -792,8 +1901,38 @@ namespace detail {
                 return ret;
             }
 
+            // the first depth + 1 elements
+            std::size_t enumSize(std::size_t depth) const
+            {
+                return std::min(m_elems.size(), saturatingAdd(depth, 1));
+            }
+
+            T enumAt(std::size_t index, std::size_t) const
+            {
+                return m_elems[index];
+            }
+
         private:
+            struct Earlier
+            {
+                std::vector<ShrinkTree<T>> operator()(const T &,
+                        const typename ShrinkTree<T>::Expand &) const
+                {
+                    std::vector<ShrinkTree<T>> ret;
+                    ret.reserve(index);
+                    for (std::size_t i = 0; i != index; ++i) {
+                        ret.emplace_back((*elems)[i],
+                                         makeExpand<T>(Earlier{elems, i}));
+                    }
+                    return ret;
+                }
+
+                const std::vector<T> *elems;
+                std::size_t index;
+            };
+
             std::vector<T> m_elems;
+            UniformIntSampler<std::size_t> m_sampler;
             std::size_t m_last_index;
     };
 }
@@ -888,6 +2027,19 @@ namespace detail {
                 throw std::runtime_error("chain: exhausted all possible generators");
             }
 
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size)
+            {
+                for (m_last_index = 0; m_last_index < m_gens.size();
+                        ++m_last_index) {
+                    try {
+                        return m_gens[m_last_index].unGenTree(rng, size);
+                    } catch (...) {
+                    }
+                }
+
+                throw std::runtime_error("chain: exhausted all possible generators");
+            }
+
             std::vector<T> shrink(const T &x)
             {
                 return m_gens[m_last_index].shrink(x);
@@ -919,39 +2071,33 @@ namespace detail {
             {
             }
 
-            T unGen(RngEngine &rng, std::size_t size)
+            T unGen(RngEngine &rng, std::size_t size) const
             {
-                m_lastgen_u.clear();
-                m_lastgen_t.clear();
-                m_lastgen_u.push_back(m_gen.unGen(rng, size));
-                m_lastgen_t.push_back(m_convert(m_lastgen_u.back()));
-                return m_lastgen_t.back();
+                return m_convert(m_gen.unGen(rng, size));
             }
 
-            std::vector<T> shrink(const T &x)
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size) const
+            {
+                return mapShrinkTree<T>(m_gen.unGenTree(rng, size),
+                                        m_convert);
+            }
+
+            // A converted value cannot be mapped back to the value it was
+            // converted from, so it only shrinks through its tree.
+            std::vector<T> shrink(const T &) const
             {
-                typename std::vector<T>::iterator it =
-                    std::find(m_lastgen_t.begin(), m_lastgen_t.end(), x);
-                assert(it != m_lastgen_t.end());
-                U last_u = m_lastgen_u[it - m_lastgen_t.begin()];
-                m_lastgen_t.clear();
-                m_lastgen_u = m_gen.shrink(last_u);
-                m_lastgen_t.reserve(m_lastgen_u.size());
-                std::transform(m_lastgen_u.begin(), m_lastgen_u.end(),
-                        std::back_inserter(m_lastgen_t), m_convert);
-                return m_lastgen_t;
+                return std::vector<T>();
             }
 
         private:
-            boost::function<T (U)> m_convert;
+            const boost::function<T (U)> m_convert;
             const Generator<U> m_gen;
-            std::vector<T> m_lastgen_t;
-            std::vector<U> m_lastgen_u;
     };
 }
 
 /// Converts a generator of U's into a generator of T's by passing the results
-/// through a function which converts U's into T's.
+/// through a function which converts U's into T's. Shrinks by converting the
+/// shrinks of the U's.
 template<class T, class U>
 Generator<T> convert(boost::function<T (U)> f,
         const Generator<U> &g = Arbitrary<U>())
@@ -980,56 +2126,38 @@ namespace detail {
             {
             }
 
-            T unGen(RngEngine &rng, std::size_t size)
+            T unGen(RngEngine &rng, std::size_t size) const
             {
-                m_lastgen_u1.clear();
-                m_lastgen_u2.clear();
-                m_lastgen_t.clear();
-                m_lastgen_u1.push_back(m_gen1.unGen(rng, size));
-                m_lastgen_u2.push_back(m_gen2.unGen(rng, size));
-                m_lastgen_t.push_back(m_combine(m_lastgen_u1.back(),
-                            m_lastgen_u2.back()));
-                return m_lastgen_t.back();
+                U1 u1 = m_gen1.unGen(rng, size);
+                U2 u2 = m_gen2.unGen(rng, size);
+                return m_combine(std::move(u1), std::move(u2));
             }
 
-            std::vector<T> shrink(const T &x)
+            ShrinkTree<T> unGenTree(RngEngine &rng, std::size_t size) const
+            {
+                ShrinkTree<U1> tree1 = m_gen1.unGenTree(rng, size);
+                ShrinkTree<U2> tree2 = m_gen2.unGenTree(rng, size);
+                return combineShrinkTrees<T>(std::move(tree1),
+                                             std::move(tree2), m_combine);
+            }
+
+            // See ConvertGenerator::shrink.
+            std::vector<T> shrink(const T &) const
             {
-                typename std::vector<T>::const_iterator it =
-                    std::find(m_lastgen_t.begin(), m_lastgen_t.end(), x);
-                assert(it != m_lastgen_t.end());
-                std::size_t dist = it - m_lastgen_t.begin();
-                U1 last_u1 = m_lastgen_u1[dist];
-                U2 last_u2 = m_lastgen_u2[dist];
-                m_lastgen_t.clear();
-                std::vector<U1> shrink1 = m_gen1.shrink(last_u1);
-                std::vector<U2> shrink2 = m_gen2.shrink(last_u2);
-                m_lastgen_u1.assign(shrink1.begin(), shrink1.end());
-                m_lastgen_u1.insert(m_lastgen_u1.end(),
-                        shrink2.size(), last_u1);
-                m_lastgen_u2.assign(shrink1.size(), last_u2);
-                m_lastgen_u2.insert(m_lastgen_u2.end(),
-                        shrink2.begin(), shrink2.end());
-
-                m_lastgen_t.reserve(m_lastgen_u1.size());
-                std::transform(m_lastgen_u1.begin(), m_lastgen_u1.end(),
-                        m_lastgen_u2.begin(), std::back_inserter(m_lastgen_t),
-                        m_combine);
-                return m_lastgen_t;
+                return std::vector<T>();
             }
 
         private:
-            boost::function<T (U1, U2)> m_combine;
+            const boost::function<T (U1, U2)> m_combine;
             const Generator<U1> m_gen1;
             const Generator<U2> m_gen2;
-            std::vector<T> m_lastgen_t;
-            std::vector<U1> m_lastgen_u1;
-            std::vector<U2> m_lastgen_u2;
     };
 }
 
 /// Combines generators of U1's and U2's into a generator of T's by passing the
 /// results through a function which converts U1's and U2's into T's. Ie. the
-/// same as convert for functions taking more than one argument.
+/// same as convert for functions taking more than one argument. Shrinks the U1
+/// first, then the U2.
 template<class T, class U1, class U2>
 Generator<T> combine(boost::function<T (U1, U2)> f,
         const Generator<U1> &g1 = Arbitrary<U1>(),
@@ -1050,8 +2178,7 @@ namespace detail {
 
             std::vector<T> unGen(RngEngine &rng, std::size_t size) const
             {
-                boost::uniform_int<std::size_t> dist(0, size);
-                std::size_t n = dist(rng);
+                std::size_t n = uniformInt<std::size_t>(rng, 0, size);
                 std::vector<T> ret;
                 ret.reserve(n);
                 while (n-- > 0)
@@ -1077,7 +2204,7 @@ namespace detail {
                 //    (array size stays the same but inner elements shrink)
                 for(int i = 0; i < static_cast<int>(v.size()); ++i) {
                     typename std::vector<T> shrinkedTypes = Arbitrary<T>::shrink(v[i]);
-                    for(T &shrinked : Arbitrary<T>::shrink(v[i])) {
+                    for(auto &&shrinked : Arbitrary<T>::shrink(v[i])) {
                         auto copy = v;
                         copy[i] = std::move(shrinked);
                         result.push_back(std::move(copy));
@@ -1086,6 +2213,38 @@ namespace detail {
                 return result;
             }
 
+            // lists of up to depth elements, each up to one less deep,
+            // the shorter first
+            std::size_t enumSize(std::size_t depth) const
+            {
+                if (depth == 0)
+                    return 1;
+                const std::size_t elems = m_gen.enumSize(depth - 1);
+                std::size_t ret = 1, lists = 1;
+                for (std::size_t n = 1; n <= depth && elems != 0; ++n) {
+                    lists = saturatingMul(lists, elems);
+                    ret = saturatingAdd(ret, lists);
+                }
+                return ret;
+            }
+
+            std::vector<T> enumAt(std::size_t index, std::size_t depth) const
+            {
+                std::vector<T> ret;
+                if (index == 0)
+                    return ret;
+                const std::size_t elems = m_gen.enumSize(depth - 1);
+                std::size_t n = 1, lists = elems;
+                for (index -= 1; index >= lists; ++n) {
+                    index -= lists;
+                    lists *= elems;
+                }
+                ret.resize(n);
+                for (std::size_t i = n; i-- > 0; index /= elems)
+                    ret[i] = m_gen.enumAt(index % elems, depth - 1);
+                return ret;
+            }
+
         private:
             const StatelessGenerator<T> m_gen;
     };
@@ -1167,6 +2326,20 @@ namespace detail {
                 return result;
             }
 
+            ShrinkTree<std::array<T, N>> unGenTree(RngEngine &rng,
+                    std::size_t size) const
+            {
+                std::array<T, N> result;
+                Expands expands;
+                for (size_t i = 0; i < N; i++) {
+                    ShrinkTree<T> tree = m_gen.unGenTree(rng, size);
+                    result[i] = std::move(tree.value());
+                    expands[i] = tree.expand();
+                }
+                return ShrinkTree<std::array<T, N>>(std::move(result),
+                    makeExpand<std::array<T, N>>(ElementShrinks{expands}));
+            }
+
             std::vector<std::array<T, N>> shrink(
                     const std::array<T, N> &arr) const
             {
@@ -1185,7 +2358,70 @@ namespace detail {
                 return result;
             }
 
+            // arrays of elements up to the same depth
+            std::size_t enumSize(std::size_t depth) const
+            {
+                const std::size_t elems = m_gen.enumSize(depth);
+                std::size_t ret = 1;
+                for (size_t i = 0; i < N; i++)
+                    ret = saturatingMul(ret, elems);
+                return ret;
+            }
+
+            std::array<T, N> enumAt(std::size_t index,
+                                    std::size_t depth) const
+            {
+                const std::size_t elems = m_gen.enumSize(depth);
+                std::array<T, N> result;
+                for (size_t i = N; i-- > 0; index /= elems)
+                    result[i] = m_gen.enumAt(index % elems, depth);
+                return result;
+            }
+
         private:
+            typedef std::array<typename ShrinkTree<T>::Expand, N> Expands;
+
+            // shrinks one element at a time, like shrink
+            struct ElementShrinks
+            {
+                std::vector<ShrinkTree<std::array<T, N>>> operator()(
+                        const std::array<T, N> &arr,
+                        const typename ShrinkTree<std::array<T, N>>::Expand
+                            &self) const
+                {
+                    std::vector<ShrinkTree<std::array<T, N>>> result;
+                    for (size_t i = 0; i < N; i++) {
+                        if (!expands[i])
+                            continue;
+                        std::vector<ShrinkTree<T>> elems =
+                            expands[i]->expand(arr[i], expands[i]);
+                        result.reserve(result.size() + elems.size());
+                        for (ShrinkTree<T> &elem : elems) {
+                            auto copy = arr;
+                            copy[i] = std::move(elem.value());
+                            result.emplace_back(std::move(copy),
+                                                next(i, elem.expand(), self));
+                        }
+                    }
+                    return result;
+                }
+
+                // the expand function of a shrink of element i
+                typename ShrinkTree<std::array<T, N>>::Expand next(
+                        size_t i, const typename ShrinkTree<T>::Expand &elem,
+                        const typename ShrinkTree<std::array<T, N>>::Expand
+                            &self) const
+                {
+                    if (elem == expands[i])
+                        return self;
+                    ElementShrinks ret = *this;
+                    ret.expands[i] = elem;
+                    return makeExpand<std::array<T, N>>(std::move(ret));
+                }
+
+                Expands expands;
+            };
+
             const StatelessGenerator<T> m_gen;
     };
 }
@@ -1245,31 +2481,6 @@ StatelessGenerator<std::vector<T> > vectorOf(std::size_t size,
 
 namespace detail {
 
-    template<int offset, typename T, typename... Ts>
-    struct TupleGeneratorHelper_unGen
-    {
-        template <typename Generators>
-        static std::tuple<T, Ts...> unGen(RngEngine &rng, std::size_t size,
-                                          const Generators &generators)
-        {
-            return std::tuple_cat(
-                std::make_tuple(std::get<offset>(generators).unGen(rng, size)),
-                TupleGeneratorHelper_unGen<
-                    offset + 1, Ts...>::unGen(rng, size, generators));
-        }
-    };
-
-    template<int offset, typename T>
-    struct TupleGeneratorHelper_unGen<offset, T>
-    {
-        template <typename Generators>
-        static std::tuple<T> unGen(RngEngine &rng, std::size_t size,
-                                   const Generators &generators)
-        {
-            return std::tuple<T>(std::get<offset>(generators).unGen(rng, size));
-        }
-    };
-
     template<int offset, typename... T>
     struct TupleGeneratorHelper_shrink
     {
@@ -1309,6 +2520,56 @@ namespace detail {
         }
     };
 
+    // shrinks one element at a time, from right to left like shrink
+    template<typename... T>
+    struct TupleShrinks
+    {
+        typedef std::tuple<typename ShrinkTree<T>::Expand...> Expands;
+        typedef typename ShrinkTree<std::tuple<T...>>::Expand Expand;
+
+        std::vector<ShrinkTree<std::tuple<T...>>> operator()(
+                const std::tuple<T...> &in, const Expand &self) const
+        {
+            std::vector<ShrinkTree<std::tuple<T...>>> out;
+            append(in, self, out,
+                   std::integral_constant<int, int(sizeof...(T)) - 1>());
+            return out;
+        }
+
+        template<int I>
+        void append(const std::tuple<T...> &in, const Expand &self,
+                    std::vector<ShrinkTree<std::tuple<T...>>> &out,
+                    std::integral_constant<int, I>) const
+        {
+            const auto &expand = std::get<I>(expands);
+            if (expand) {
+                auto elems = expand->expand(std::get<I>(in), expand);
+                out.reserve(out.size() + elems.size());
+                for (auto &elem : elems) {
+                    auto copy = in;
+                    std::get<I>(copy) = std::move(elem.value());
+                    if (elem.expand() == expand) {
+                        out.emplace_back(std::move(copy), self);
+                    } else {
+                        TupleShrinks next = *this;
+                        std::get<I>(next.expands) = elem.expand();
+                        out.emplace_back(std::move(copy),
+                            makeExpand<std::tuple<T...>>(std::move(next)));
+                    }
+                }
+            }
+            append(in, self, out, std::integral_constant<int, I - 1>());
+        }
+
+        void append(const std::tuple<T...> &, const Expand &,
+                    std::vector<ShrinkTree<std::tuple<T...>>> &,
+                    std::integral_constant<int, -1>) const
+        {
+        }
+
+        Expands expands;
+    };
+
     template<typename... T>
     struct TupleGenerator
     {
@@ -1319,7 +2580,17 @@ namespace detail {
 
         std::tuple<T...> unGen(RngEngine &rng, std::size_t size) const
         {
-            return TupleGeneratorHelper_unGen<0, T...>::unGen(rng, size, m_gen);
+            if (quasiRandomFor(rng))
+                return unGenTree(rng, size).value();
+            return unGen(rng, size,
+                         typename MakeIndexList<sizeof...(T)>::type());
+        }
+
+        ShrinkTree<std::tuple<T...>> unGenTree(RngEngine &rng,
+                                               std::size_t size) const
+        {
+            return unGenTree(rng, size,
+                             typename MakeIndexList<sizeof...(T)>::type());
         }
 
         std::vector<std::tuple<T...>> shrink(const std::tuple<T...> &shrinkInput) const
@@ -1331,7 +2602,99 @@ namespace detail {
             return shrinkOutput;
         }
 
+        // tuples of elements up to the same depth, the last varying fastest
+        std::size_t enumSize(std::size_t depth) const
+        {
+            return enumSize(depth,
+                            typename MakeIndexList<sizeof...(T)>::type());
+        }
+
+        std::tuple<T...> enumAt(std::size_t index, std::size_t depth) const
+        {
+            return enumAt(index, depth,
+                          typename MakeIndexList<sizeof...(T)>::type());
+        }
+
     private:
+        template<std::size_t... I>
+        std::size_t enumSize(std::size_t depth, IndexList<I...>) const
+        {
+            std::size_t ret = 1;
+            for (std::size_t n : {std::get<I>(m_gen).enumSize(depth)...})
+                ret = saturatingMul(ret, n);
+            return ret;
+        }
+
+        template<std::size_t... I>
+        std::tuple<T...> enumAt(std::size_t index, std::size_t depth,
+                                IndexList<I...>) const
+        {
+            const std::size_t sizes[] = {
+                std::get<I>(m_gen).enumSize(depth)...};
+            std::size_t indices[sizeof...(T)];
+            for (std::size_t i = sizeof...(T); i-- > 0; index /= sizes[i])
+                indices[i] = index % sizes[i];
+            return std::tuple<T...>{
+                std::get<I>(m_gen).enumAt(indices[I], depth)...};
+        }
+
+        // braced initialization generates the elements from left to right
+        template<std::size_t... I>
+        std::tuple<T...> unGen(RngEngine &rng, std::size_t size,
+                               IndexList<I...>) const
+        {
+            return std::tuple<T...>{std::get<I>(m_gen).unGen(rng, size)...};
+        }
+
+        // whether the elements are taken from the quasi-random sequence,
+        // or from the choices that recorded them
+        bool quasiRandomFor(const RngEngine &rng) const
+        {
+            if (!quasiRandom() || (!rng.hasRunPosition() && !rng.replaying()))
+                return false;
+            return hasQuantiles(typename MakeIndexList<sizeof...(T)>::type());
+        }
+
+        template<std::size_t... I>
+        bool hasQuantiles(IndexList<I...>) const
+        {
+            for (bool has : {std::get<I>(m_gen).hasQuantile()...}) {
+                if (!has)
+                    return false;
+            }
+            return true;
+        }
+
+        // quasi-random elements take the dimensions from dimension on
+        template<std::size_t I>
+        ShrinkTree<typename std::tuple_element<I, std::tuple<T...>>::type>
+        elementTree(RngEngine &rng, std::size_t size, bool quasi,
+                    std::size_t dimension) const
+        {
+            if (quasi) {
+                return std::get<I>(m_gen).quantileTree(
+                    quasiRandomQuantile(rng, dimension + I), size);
+            }
+            return std::get<I>(m_gen).unGenTree(rng, size);
+        }
+
+        template<std::size_t... I>
+        ShrinkTree<std::tuple<T...>> unGenTree(RngEngine &rng,
+                std::size_t size, IndexList<I...>) const
+        {
+            const bool quasi = quasiRandomFor(rng);
+            const std::size_t dimension =
+                quasi ? rng.takeDimensions(sizeof...(T)) : 0;
+            std::tuple<ShrinkTree<T>...> trees{
+                elementTree<I>(rng, size, quasi, dimension)...};
+            typename TupleShrinks<T...>::Expands expands(
+                std::get<I>(trees).expand()...);
+            return ShrinkTree<std::tuple<T...>>(
+                std::tuple<T...>(std::move(std::get<I>(trees).value())...),
+                makeExpand<std::tuple<T...>>(
+                    TupleShrinks<T...>{std::move(expands)}));
+        }
+
         std::tuple<Generator<T>...> m_gen;
     };
 
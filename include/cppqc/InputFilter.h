@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_INPUT_FILTER_H
+#define CPPQC_INPUT_FILTER_H
+
+#include "BinaryDump.h"
+
+#include <cstdint>
+#include <streambuf>
+#include <vector>
+
+// Duplicate suppression for properties that override skipDuplicates (see
+// PropertyBase). Inputs are hashed through their BinaryDump, and the
+// hashes are kept in a Bloom filter, so that the memory per test case is
+// constant whatever the size of the inputs. A false positive skips an
+// input that was never checked; with the filter sized for the number of
+// tests, that happens for less than one input in a thousand.
+
+namespace cppqc {
+
+namespace detail {
+    // Hashes everything written to it with 64 bit FNV-1a.
+    class HashStreamBuf : public std::streambuf
+    {
+        public:
+            HashStreamBuf() : m_hash(14695981039346656037ULL) {}
+
+            std::uint64_t hash() const
+            {
+                // FNV-1a mixes the last bytes poorly into the high bits,
+                // which the Bloom filter depends on
+                std::uint64_t h = m_hash;
+                h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+                return h ^ (h >> 31);
+            }
+
+        protected:
+            int_type overflow(int_type c) override
+            {
+                if (!traits_type::eq_int_type(c, traits_type::eof()))
+                    add(traits_type::to_char_type(c));
+                return traits_type::not_eof(c);
+            }
+
+            std::streamsize xsputn(const char *s, std::streamsize n) override
+            {
+                for (std::streamsize i = 0; i < n; ++i)
+                    add(s[i]);
+                return n;
+            }
+
+        private:
+            void add(char c)
+            {
+                m_hash = (m_hash ^ static_cast<unsigned char>(c)) *
+                         1099511628211ULL;
+            }
+
+            std::uint64_t m_hash;
+    };
+
+    template<class Input>
+    std::uint64_t hashInput(const Input &in)
+    {
+        HashStreamBuf buf;
+        std::ostream out(&buf);
+        dumpTo(out, in);
+        return buf.hash();
+    }
+
+    class BloomFilter
+    {
+        public:
+            // Sized for the given number of elements.
+            explicit BloomFilter(std::size_t expected) :
+                m_bits(roundUp(expected * BITS_PER_ELEMENT), false)
+            {
+            }
+
+            // Adds the hash and returns whether it was (probably) added
+            // before.
+            bool insert(std::uint64_t hash)
+            {
+                // double hashing: the k indices are h1 + i * h2
+                const std::uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+                bool seen = true;
+                for (std::uint64_t i = 0; i < NUM_HASHES; ++i) {
+                    const std::size_t bit =
+                        std::size_t((h1 + i * h2) & (m_bits.size() - 1));
+                    if (!m_bits[bit]) {
+                        seen = false;
+                        m_bits[bit] = true;
+                    }
+                }
+                return seen;
+            }
+
+        private:
+            static const std::size_t BITS_PER_ELEMENT = 16;
+            static const std::size_t NUM_HASHES = 8;
+
+            // a power of two, so that indices are masked, not divided
+            static std::size_t roundUp(std::size_t n)
+            {
+                std::size_t bits = 64;
+                while (bits < n)
+                    bits *= 2;
+                return bits;
+            }
+
+            std::vector<bool> m_bits;
+    };
+}
+
+}
+
+#endif
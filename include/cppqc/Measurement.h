@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_MEASUREMENT_H
+#define CPPQC_MEASUREMENT_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cppqc {
+
+/// Runs the function once and returns the elapsed wall time in nanoseconds.
+template<class F>
+double measureNanoseconds(F &&f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+namespace detail {
+    inline double median(std::vector<double> values)
+    {
+        if (values.empty())
+            return 0.0;
+        const std::size_t mid = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + mid, values.end());
+        if (values.size() % 2 == 1)
+            return values[mid];
+        const double upper = values[mid];
+        const double lower = *std::max_element(values.begin(),
+                                               values.begin() + mid);
+        return (lower + upper) / 2;
+    }
+}
+
+/// Runs the function several times and returns the median wall time in
+/// nanoseconds. The median is robust against outliers caused by
+/// preemption, page faults or cold caches.
+template<class F>
+double medianNanoseconds(std::size_t repetitions, F &&f)
+{
+    std::vector<double> timings;
+    timings.reserve(repetitions);
+    for (std::size_t i = 0; i < repetitions; ++i)
+        timings.push_back(measureNanoseconds(f));
+    return detail::median(std::move(timings));
+}
+
+/// Summary of the values that one measurement took over several checks.
+/// Besides the mean and the range, it keeps a histogram of the values
+/// with logarithmic buckets (about 1% wide), so that percentiles can be
+/// reported without storing every value.
+struct MeasurementStats
+{
+    MeasurementStats() :
+        count(0), sum(0),
+        min(std::numeric_limits<double>::infinity()),
+        max(-std::numeric_limits<double>::infinity())
+    {
+    }
+
+    void add(double value)
+    {
+        ++count;
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+        ++histogram[histogramBucket(value)];
+    }
+
+    double mean() const
+    {
+        return count == 0 ? 0.0 : sum / double(count);
+    }
+
+    /// Returns the value below which the fraction "p" (0..1) of the
+    /// recorded values lie, accurate to the histogram bucket width.
+    double percentile(double p) const
+    {
+        if (histogram.empty())
+            return 0.0;
+        const double rank = std::max(1.0, std::ceil(p * double(count)));
+        std::size_t seen = 0;
+        for (const auto &bucket : histogram) {
+            seen += bucket.second;
+            if (double(seen) >= rank)
+                return std::min(max, std::max(min, bucket.first));
+        }
+        return max;
+    }
+
+    // Maps a value to the lower end (by magnitude) of its bucket.
+    static double histogramBucket(double value)
+    {
+        if (value == 0 || !std::isfinite(value))
+            return value;
+        const double base = 1.01;
+        const double magnitude = std::pow(base,
+            std::floor(std::log(std::abs(value)) / std::log(base)));
+        return value < 0 ? -magnitude : magnitude;
+    }
+
+    std::size_t count;
+    double sum;
+    double min;
+    double max;
+    // number of values per bucket, see histogramBucket
+    std::map<double, std::size_t> histogram;
+};
+
+/// Measurements by name (e.g., "allocations").
+typedef std::map<std::string, MeasurementStats> MeasurementTable;
+
+/// A probe measures a resource consumed by each check (e.g., memory
+/// allocations). The runner starts all registered probes right before
+/// checking an input and stops them right afterwards. In "stop", a probe
+/// reports its values through recordMeasurement.
+class CheckProbe
+{
+    public:
+        virtual void start() = 0;
+        virtual void stop() = 0;
+
+        virtual ~CheckProbe() {}
+};
+
+namespace detail {
+    typedef std::vector<std::pair<std::string, double> > CheckMeasurements;
+
+    inline std::vector<CheckProbe *> &checkProbes()
+    {
+        static std::vector<CheckProbe *> probes;
+        return probes;
+    }
+
+    inline CheckMeasurements *&currentCheckMeasurements()
+    {
+        static thread_local CheckMeasurements *current = nullptr;
+        return current;
+    }
+}
+
+/// Records a value for the check that is currently running on this thread.
+/// The runner aggregates the values per label and per size bucket and
+/// reports them together with the labels. Outside of a check run by the
+/// runner (e.g., while shrinking), the value is ignored.
+inline void recordMeasurement(const std::string &name, double value)
+{
+    detail::CheckMeasurements *current = detail::currentCheckMeasurements();
+    if (current != nullptr)
+        current->push_back(std::make_pair(name, value));
+}
+
+/// Registers a probe for as long as the object lives.
+class ProbeRegistration
+{
+    public:
+        explicit ProbeRegistration(CheckProbe &probe) : m_probe(&probe)
+        {
+            detail::checkProbes().push_back(m_probe);
+        }
+
+        ~ProbeRegistration()
+        {
+            std::vector<CheckProbe *> &probes = detail::checkProbes();
+            probes.erase(std::remove(probes.begin(), probes.end(), m_probe),
+                         probes.end());
+        }
+
+    private:
+        ProbeRegistration(const ProbeRegistration &);
+        ProbeRegistration &operator=(const ProbeRegistration &);
+
+        CheckProbe *m_probe;
+};
+
+namespace detail {
+    // Collects the measurements of one check: runs the probes and
+    // redirects recordMeasurement into "measurements" while alive.
+    class MeasurementScope
+    {
+        public:
+            // Values that fit without reallocating: one per built-in
+            // probe value plus a few recorded by the property itself.
+            static const std::size_t reservedMeasurements = 8;
+
+            explicit MeasurementScope(CheckMeasurements &measurements) :
+                m_previous(currentCheckMeasurements())
+            {
+                // reserved before the probes start, so that recording a
+                // few values is not counted as an allocation of the check
+                measurements.reserve(reservedMeasurements);
+                currentCheckMeasurements() = &measurements;
+                for (CheckProbe *probe : checkProbes())
+                    probe->start();
+            }
+
+            ~MeasurementScope()
+            {
+                const std::vector<CheckProbe *> &probes = checkProbes();
+                for (auto it = probes.rbegin(); it != probes.rend(); ++it)
+                    (*it)->stop();
+                currentCheckMeasurements() = m_previous;
+            }
+
+        private:
+            CheckMeasurements *m_previous;
+    };
+
+    /// Groups generation sizes into buckets of powers of two (0, 1, 2..3,
+    /// 4..7, ...) and returns the smallest size of the bucket.
+    inline std::size_t sizeBucket(std::size_t size)
+    {
+        std::size_t bucket = 1;
+        if (size == 0)
+            return 0;
+        while (size >= 2 * bucket)
+            bucket *= 2;
+        return bucket;
+    }
+
+    inline void addMeasurements(MeasurementTable &table,
+                                const CheckMeasurements &measurements)
+    {
+        for (const auto &m : measurements)
+            table[m.first].add(m.second);
+    }
+}
+
+}
+
+#endif
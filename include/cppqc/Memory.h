@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_MEMORY_H
+#define CPPQC_MEMORY_H
+
+#include "AllocationCounter.h"
+#include "Performance.h"
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Memory tracking builds on allocation counting, so link against the
+// "cppqc-alloc" library to use it.
+
+namespace cppqc {
+
+/// Returns the resident set size of the process in bytes, or 0 where it
+/// cannot be determined. Does not allocate, so it can be sampled inside
+/// probes without disturbing the heap counters.
+inline std::size_t residentBytes()
+{
+#ifdef __linux__
+    const int fd = ::open("/proc/self/statm", O_RDONLY);
+    if (fd == -1)
+        return 0;
+    char buf[128];
+    const ssize_t n = ::read(fd, buf, sizeof(buf) - 1);
+    ::close(fd);
+    if (n <= 0)
+        return 0;
+    buf[n] = '\0';
+
+    // the second field is the number of resident pages
+    const char *p = buf;
+    while (*p != '\0' && *p != ' ')
+        ++p;
+    std::size_t pages = 0;
+    for (++p; *p >= '0' && *p <= '9'; ++p)
+        pages = pages * 10 + std::size_t(*p - '0');
+    return pages * std::size_t(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+/// Watches the heap and the resident set size across checks to detect
+/// leaks and caches that only grow. Every check is expected to release
+/// what it allocates, independently of the size of its input; a check
+/// that keeps bytes allocated after returning "retains" them. Growth is
+/// flagged if most checks retain memory.
+///
+///     cppqc::MemoryGrowthProbe growth;
+///     cppqc::ProbeRegistration registration(growth);
+///     cppqc::quickCheckOutput(MyProperty());
+///     growth.report(std::cout);
+class MemoryGrowthProbe : public CheckProbe
+{
+    public:
+        MemoryGrowthProbe() :
+            m_checks(0), m_retainingChecks(0), m_retainedBytes(0),
+            m_startLive(0), m_firstResident(0), m_lastResident(0),
+            m_peakResident(0)
+        {
+        }
+
+        void start() override
+        {
+            m_startLive = threadLiveBytes();
+            if (m_checks == 0)
+                m_firstResident = residentBytes();
+        }
+
+        void stop() override
+        {
+            const std::ptrdiff_t retained = threadLiveBytes() - m_startLive;
+            ++m_checks;
+            if (retained > 0)
+                ++m_retainingChecks;
+            m_retainedBytes += retained;
+            m_lastResident = residentBytes();
+            if (m_lastResident > m_peakResident)
+                m_peakResident = m_lastResident;
+        }
+
+        std::size_t checks() const
+        {
+            return m_checks;
+        }
+
+        /// Number of checks that returned with more heap bytes allocated
+        /// than when they started.
+        std::size_t retainingChecks() const
+        {
+            return m_retainingChecks;
+        }
+
+        /// Net heap bytes retained over all checks.
+        std::ptrdiff_t retainedBytes() const
+        {
+            return m_retainedBytes;
+        }
+
+        /// Growth of the resident set size from the first to the last
+        /// check; noisier than the heap counters, as allocators keep
+        /// freed memory mapped.
+        std::ptrdiff_t residentGrowth() const
+        {
+            return std::ptrdiff_t(m_lastResident) -
+                   std::ptrdiff_t(m_firstResident);
+        }
+
+        std::size_t peakResidentBytes() const
+        {
+            return m_peakResident;
+        }
+
+        /// True if the heap grew overall and at least the given fraction
+        /// of the checks retained memory. A cache that is filled once by
+        /// the first checks does not count as growth.
+        bool growthDetected(double minRetainingFraction = 0.5) const
+        {
+            return m_checks >= 10 && m_retainedBytes > 0 &&
+                m_retainingChecks >= minRetainingFraction * m_checks;
+        }
+
+        void report(std::ostream &out) const
+        {
+            if (growthDetected()) {
+                out << "Memory grows across checks: " << m_retainingChecks
+                    << " of " << m_checks << " checks retained a total of "
+                    << m_retainedBytes << " heap bytes";
+            } else {
+                out << "No memory growth across " << m_checks
+                    << " checks (" << m_retainedBytes
+                    << " heap bytes retained)";
+            }
+            if (m_peakResident != 0) {
+                out << ", resident set grew by " << residentGrowth()
+                    << " bytes to a peak of " << m_peakResident << " bytes";
+            }
+            out << '.' << std::endl;
+        }
+
+    private:
+        std::size_t m_checks;
+        std::size_t m_retainingChecks;
+        std::ptrdiff_t m_retainedBytes;
+        std::ptrdiff_t m_startLive;
+        std::size_t m_firstResident;
+        std::size_t m_lastResident;
+        std::size_t m_peakResident;
+};
+
+/// A property that searches for memory-hungry inputs. Its cost is the peak
+/// number of heap bytes that "run" holds at once, so inputs that need more
+/// than maxBytes fail and are shrunk to a small memory-hungry
+/// counterexample. The input with the highest peak seen so far is kept
+/// for reporting.
+template<class... T>
+class MemoryProperty : public PerformanceProperty<T...>
+{
+    public:
+        typedef typename Property<T...>::Input Input;
+
+        explicit MemoryProperty(std::size_t maxBytes) :
+            PerformanceProperty<T...>(double(maxBytes)),
+            m_peakBytes(-1)
+        {
+        }
+
+        MemoryProperty(std::size_t maxBytes, const Generator<T> &...g) :
+            PerformanceProperty<T...>(double(maxBytes), g...),
+            m_peakBytes(-1)
+        {
+        }
+
+        /// Highest peak of heap bytes of any input so far, or -1 if no
+        /// input was checked.
+        std::ptrdiff_t peakBytes() const
+        {
+            return m_peakBytes;
+        }
+
+        /// The input that reached peakBytes, or null.
+        const Input *peakInput() const
+        {
+            return m_peakInput.get();
+        }
+
+    protected:
+        std::size_t repetitions() const override
+        {
+            return 1;
+        }
+
+    private:
+        virtual void run(const T &...) const = 0;
+
+        double cost(const T &...v) const override
+        {
+            std::ptrdiff_t peak;
+            {
+                AllocationCounter counter;
+                run(v...);
+                peak = counter.peakBytes();
+            }
+            if (peak > m_peakBytes) {
+                // keeping the input must not look like a leak of the check
+                UncountedAllocations uncounted;
+                m_peakBytes = peak;
+                m_peakInput.reset(new Input(v...));
+            }
+            return double(peak);
+        }
+
+        mutable std::ptrdiff_t m_peakBytes;
+        mutable std::unique_ptr<Input> m_peakInput;
+};
+
+struct MemoryResult : Result
+{
+    bool memoryGrowth;
+    std::ptrdiff_t retainedBytes;
+};
+
+/// Runs a memory property like quickCheckOutput while watching for memory
+/// growth across checks. Reports the input with the highest heap peak,
+/// whether the heap grew, and, if an input needed more than the allowed
+/// bytes, the peak of the shrunk counterexample.
+template<class... T>
+MemoryResult quickCheckMemory(const MemoryProperty<T...> &prop,
+        std::ostream &out = std::cout,
+        std::size_t maxSuccess = 100,
+        std::size_t maxDiscarded = 0, std::size_t maxSize = 0,
+        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
+        SeedType seed = USE_DEFAULT_SEED)
+{
+    MemoryGrowthProbe growth;
+    MemoryResult ret;
+    {
+        ProbeRegistration registration(growth);
+        static_cast<Result &>(ret) = quickCheckOutput(prop, out, maxSuccess,
+            maxDiscarded, maxSize, shrinkTimeout, seed);
+    }
+    ret.memoryGrowth = growth.growthDetected();
+    ret.retainedBytes = growth.retainedBytes();
+
+    growth.report(out);
+    if (prop.peakInput() != nullptr) {
+        out << "Peak heap usage of " << prop.peakBytes()
+            << " bytes for the input:\n";
+        printInput(out, *prop.peakInput());
+    }
+    if (ret.result == QC_FAILURE) {
+        out << "Peak heap bytes of the counterexample: "
+            << prop.lastFailureCost() << " (limit " << prop.threshold()
+            << ")" << std::endl;
+    }
+    return ret;
+}
+
+}
+
+#endif
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_MUTATE_H
+#define CPPQC_MUTATE_H
+
+#include "Arbitrary.h"
+
+#include <array>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Mutation-based generation: mutate(seeds, g) explores around hand-picked
+// inputs instead of generating from scratch. Every value is one of the
+// seeds with a few random mutations applied. A mutation either takes one
+// of the shrinks of the value under g, or applies one of the mutations of
+// its type (see Mutations): bit flips, small steps and edge cases for
+// integers, and inserting, duplicating, swapping, removing and mutating
+// elements of vectors and strings. The larger the size, the more
+// mutations are applied.
+
+namespace cppqc {
+
+/*
+ * Mutations<T> changes a value of type T a little, in a random way.
+ * Specialize it for other types:
+ *
+ *      template<>
+ *      struct Mutations<MyType>
+ *      {
+ *          static const bool supported = true;
+ *          static void mutate(RngEngine &rng, MyType &x, std::size_t size);
+ *      };
+ */
+template<class T, class Enable = void>
+struct Mutations
+{
+    static const bool supported = false;
+};
+
+namespace detail {
+    template<class T>
+    typename std::enable_if<Mutations<T>::supported>::type
+    mutateValue(RngEngine &rng, T &x, std::size_t size)
+    {
+        Mutations<T>::mutate(rng, x, size);
+    }
+
+    template<class T>
+    typename std::enable_if<!Mutations<T>::supported>::type
+    mutateValue(RngEngine &, T &, std::size_t)
+    {
+    }
+
+    // Inserts, duplicates, swaps, removes or mutates elements.
+    template<class Sequence>
+    void mutateSequence(RngEngine &rng, Sequence &s, std::size_t size)
+    {
+        typedef typename Sequence::value_type Element;
+        if (s.empty())
+            return;
+        const std::size_t i = uniformInt<std::size_t>(rng, 0, s.size() - 1);
+        switch (uniformInt<int>(rng, 0, 4)) {
+        case 0: {
+            // a mutated copy of an element, next to it
+            Element e = s[i];
+            mutateValue(rng, e, size);
+            s.insert(s.begin() + i, e);
+            break;
+        }
+        case 1: {
+            // a run of elements, repeated after itself
+            const std::size_t end =
+                uniformInt<std::size_t>(rng, i + 1, s.size());
+            const Sequence run(s.begin() + i, s.begin() + end);
+            s.insert(s.begin() + end, run.begin(), run.end());
+            break;
+        }
+        case 2:
+            std::swap(s[i],
+                      s[uniformInt<std::size_t>(rng, 0, s.size() - 1)]);
+            break;
+        case 3:
+            s.erase(s.begin() + i);
+            break;
+        default:
+            if (Mutations<Element>::supported)
+                mutateValue(rng, s[i], size);
+            else
+                s.erase(s.begin() + i);
+            break;
+        }
+    }
+
+    template<class... T>
+    struct AnyMutable;
+
+    template<>
+    struct AnyMutable<> : std::false_type {};
+
+    template<class T, class... Rest>
+    struct AnyMutable<T, Rest...> : std::integral_constant<bool,
+        Mutations<T>::supported || AnyMutable<Rest...>::value> {};
+
+    // Mutates one of the elements that have Mutations.
+    template<class... T, std::size_t... I>
+    void mutateElement(RngEngine &rng, std::tuple<T...> &x, std::size_t size,
+                       IndexList<I...>)
+    {
+        const bool supported[] = { Mutations<T>::supported... };
+        std::size_t indices[sizeof...(T)];
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < sizeof...(T); ++i) {
+            if (supported[i])
+                indices[n++] = i;
+        }
+        if (n == 0)
+            return;
+        const std::size_t chosen =
+            indices[uniformInt<std::size_t>(rng, 0, n - 1)];
+        const int expand[] = { 0, (I == chosen ?
+            (mutateValue(rng, std::get<I>(x), size), 0) : 0)... };
+        (void) expand;
+    }
+}
+
+template<>
+struct Mutations<bool>
+{
+    static const bool supported = true;
+
+    static void mutate(RngEngine &, bool &x, std::size_t)
+    {
+        x = !x;
+    }
+};
+
+// Flips a bit, takes a small step, or jumps to an edge case (see
+// edgeCasePercent).
+template<class Integral>
+struct Mutations<Integral, typename std::enable_if<
+    std::is_integral<Integral>::value &&
+    !std::is_same<Integral, bool>::value>::type>
+{
+    static const bool supported = true;
+
+    static void mutate(RngEngine &rng, Integral &x, std::size_t)
+    {
+        typedef typename std::make_unsigned<Integral>::type Unsigned;
+        typedef std::numeric_limits<Integral> Limits;
+        switch (detail::uniformInt<int>(rng, 0, 2)) {
+        case 0: {
+            const int bit = detail::uniformInt<int>(rng, 0,
+                std::numeric_limits<Unsigned>::digits - 1);
+            x = Integral(Unsigned(x) ^ Unsigned(Unsigned(1) << bit));
+            break;
+        }
+        case 1: {
+            // wraps around at the limits of the type
+            const Unsigned step = detail::uniformInt<Unsigned>(rng, 1, 16);
+            x = detail::uniformInt<int>(rng, 0, 1) == 0 ?
+                Integral(Unsigned(x) + step) : Integral(Unsigned(x) - step);
+            break;
+        }
+        default:
+            x = detail::edgeCase(rng, Limits::min(), Limits::max());
+            break;
+        }
+    }
+};
+
+// Negates, halves, doubles, or adds a step of up to one.
+template<class Real>
+struct Mutations<Real, typename std::enable_if<
+    std::is_floating_point<Real>::value>::type>
+{
+    static const bool supported = true;
+
+    static void mutate(RngEngine &rng, Real &x, std::size_t)
+    {
+        switch (detail::uniformInt<int>(rng, 0, 3)) {
+        case 0:
+            x = -x;
+            break;
+        case 1:
+            x /= 2;
+            break;
+        case 2:
+            x *= 2;
+            break;
+        default:
+            x += Real(2.0 * detail::next32(rng) / 0xffffffffu - 1.0);
+            break;
+        }
+    }
+};
+
+template<class T>
+struct Mutations<std::vector<T>>
+{
+    static const bool supported = true;
+
+    static void mutate(RngEngine &rng, std::vector<T> &x, std::size_t size)
+    {
+        detail::mutateSequence(rng, x, size);
+    }
+};
+
+template<>
+struct Mutations<std::vector<bool>>
+{
+    static const bool supported = true;
+
+    static void mutate(RngEngine &rng, std::vector<bool> &x, std::size_t)
+    {
+        if (x.empty())
+            return;
+        const std::size_t i = detail::uniformInt<std::size_t>(rng, 0,
+                                                              x.size() - 1);
+        switch (detail::uniformInt<int>(rng, 0, 2)) {
+        case 0:
+            x.insert(x.begin() + i, !x[i]);
+            break;
+        case 1:
+            x.erase(x.begin() + i);
+            break;
+        default:
+            x[i] = !x[i];
+            break;
+        }
+    }
+};
+
+template<>
+struct Mutations<std::string>
+{
+    static const bool supported = true;
+
+    static void mutate(RngEngine &rng, std::string &x, std::size_t size)
+    {
+        detail::mutateSequence(rng, x, size);
+    }
+};
+
+template<class T, std::size_t N>
+struct Mutations<std::array<T, N>>
+{
+    static const bool supported = N != 0;
+
+    static void mutate(RngEngine &rng, std::array<T, N> &x, std::size_t size)
+    {
+        const std::size_t i = detail::uniformInt<std::size_t>(rng, 0, N - 1);
+        if (!Mutations<T>::supported || detail::uniformInt<int>(rng, 0, 1)) {
+            std::swap(x[i], x[detail::uniformInt<std::size_t>(rng, 0,
+                                                              N - 1)]);
+        } else {
+            detail::mutateValue(rng, x[i], size);
+        }
+    }
+};
+
+template<class T1, class T2>
+struct Mutations<std::pair<T1, T2>>
+{
+    static const bool supported =
+        Mutations<T1>::supported || Mutations<T2>::supported;
+
+    static void mutate(RngEngine &rng, std::pair<T1, T2> &x,
+                       std::size_t size)
+    {
+        const bool first = !Mutations<T2>::supported ||
+            (Mutations<T1>::supported && detail::uniformInt<int>(rng, 0, 1));
+        if (first)
+            detail::mutateValue(rng, x.first, size);
+        else
+            detail::mutateValue(rng, x.second, size);
+    }
+};
+
+template<class... T>
+struct Mutations<std::tuple<T...>>
+{
+    static const bool supported = detail::AnyMutable<T...>::value;
+
+    static void mutate(RngEngine &rng, std::tuple<T...> &x, std::size_t size)
+    {
+        detail::mutateElement(rng, x, size,
+            typename detail::MakeIndexList<sizeof...(T)>::type());
+    }
+};
+
+namespace detail {
+    template<class T>
+    class MutateStatelessGenerator
+    {
+        public:
+            MutateStatelessGenerator(const std::vector<T> &seeds,
+                                     const StatelessGenerator<T> &g) :
+                m_seeds(seeds), m_gen(g)
+            {
+                if (seeds.empty())
+                    throw std::invalid_argument("mutate: no seeds given");
+            }
+
+            T unGen(RngEngine &rng, std::size_t size) const
+            {
+                T x = m_seeds[uniformInt<std::size_t>(rng, 0,
+                                                      m_seeds.size() - 1)];
+                const std::size_t numMutations =
+                    uniformInt<std::size_t>(rng, 1, 1 + size / 10);
+                for (std::size_t i = 0; i < numMutations; ++i)
+                    mutateOnce(rng, x, size);
+                return x;
+            }
+
+            std::vector<T> shrink(const T &x) const
+            {
+                return m_gen.shrink(x);
+            }
+
+        private:
+            // one of the shrinks in a quarter of the mutations, or in all
+            // of them if the type has no Mutations
+            void mutateOnce(RngEngine &rng, T &x, std::size_t size) const
+            {
+                if (Mutations<T>::supported &&
+                    uniformInt<int>(rng, 0, 3) != 0) {
+                    mutateValue(rng, x, size);
+                    return;
+                }
+                std::vector<T> shrinks = m_gen.shrink(x);
+                if (!shrinks.empty()) {
+                    x = std::move(shrinks[uniformInt<std::size_t>(rng, 0,
+                        shrinks.size() - 1)]);
+                }
+            }
+
+            const std::vector<T> m_seeds;
+            const StatelessGenerator<T> m_gen;
+    };
+}
+
+/// Generates values close to the given seeds: one of them, with random
+/// mutations applied (see Mutations). The more mutations, the larger the
+/// size. Shrinks with g; requires at least one seed.
+template<class T>
+StatelessGenerator<T> mutate(const std::vector<T> &seeds,
+        const StatelessGenerator<T> &g = Arbitrary<T>())
+{
+    return detail::MutateStatelessGenerator<T>(seeds, g);
+}
+
+}
+
+#endif
@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_PERF_COUNTERS_H
+#define CPPQC_PERF_COUNTERS_H
+
+#include "Measurement.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace cppqc {
+
+enum PerfEvent
+{
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,
+    PERF_BRANCH_MISSES,
+    NUM_PERF_EVENTS
+};
+
+inline const char *perfEventName(PerfEvent e)
+{
+    switch (e) {
+        case PERF_CYCLES: return "cycles";
+        case PERF_INSTRUCTIONS: return "instructions";
+        case PERF_CACHE_MISSES: return "cache misses";
+        case PERF_BRANCH_MISSES: return "branch misses";
+        case NUM_PERF_EVENTS: break;
+    }
+    return "?";
+}
+
+/// Hardware counter values of one measurement. Counters that could not be
+/// opened are NaN; the wall time is always available.
+struct PerfCounterValues
+{
+    PerfCounterValues() : wallNanoseconds(0)
+    {
+        for (double &v : counters)
+            v = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    bool has(PerfEvent e) const
+    {
+        return !std::isnan(counters[e]);
+    }
+
+    double operator[](PerfEvent e) const
+    {
+        return counters[e];
+    }
+
+    /// Checks an upper bound on a counter. An unavailable counter (e.g.,
+    /// inside containers or VMs) cannot violate the bound, but every
+    /// unchecked bound is recorded as the measurement "unchecked <counter>
+    /// bound", so the run report shows that the bound was skipped.
+    bool atMost(PerfEvent e, double bound) const
+    {
+        if (has(e))
+            return counters[e] <= bound;
+        recordMeasurement(std::string("unchecked ") + perfEventName(e) +
+                          " bound", 1);
+        return true;
+    }
+
+    /// Checks an upper bound on a counter, or on the wall time if the
+    /// counter is unavailable.
+    bool atMost(PerfEvent e, double bound, double wallNanosecondsBound) const
+    {
+        return has(e) ? counters[e] <= bound :
+                        wallNanoseconds <= wallNanosecondsBound;
+    }
+
+    double counters[NUM_PERF_EVENTS];
+    double wallNanoseconds;
+};
+
+/// Counts cycles, instructions, cache misses and branch misses of the
+/// calling thread through perf_event_open (Linux only, user space only).
+/// If the kernel refuses to open the counters (missing permissions,
+/// perf_event_paranoid, containers, other platforms), only the wall time
+/// is measured.
+///
+///     cppqc::PerfCounters counters;
+///     const cppqc::PerfCounterValues v = counters.measure([&] { f(x); });
+///     return v.atMost(cppqc::PERF_INSTRUCTIONS, 1000.0 * x.size());
+class PerfCounters
+{
+    public:
+        PerfCounters()
+        {
+            for (int &fd : m_fds)
+                fd = -1;
+            open();
+        }
+
+        ~PerfCounters()
+        {
+            close();
+        }
+
+        /// True if at least one hardware counter could be opened.
+        bool available() const
+        {
+            return m_leader != -1;
+        }
+
+        void start()
+        {
+#ifdef __linux__
+            if (m_leader != -1) {
+                ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+                ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            }
+#endif
+            m_start = std::chrono::steady_clock::now();
+        }
+
+        PerfCounterValues stop()
+        {
+            const auto end = std::chrono::steady_clock::now();
+            PerfCounterValues values;
+#ifdef __linux__
+            if (m_leader != -1) {
+                ioctl(m_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+                readGroup(values);
+            }
+#endif
+            const std::chrono::duration<double, std::nano> elapsed =
+                end - m_start;
+            values.wallNanoseconds = elapsed.count();
+            return values;
+        }
+
+        template<class F>
+        PerfCounterValues measure(F &&f)
+        {
+            start();
+            f();
+            return stop();
+        }
+
+    private:
+        PerfCounters(const PerfCounters &);
+        PerfCounters &operator=(const PerfCounters &);
+
+#ifdef __linux__
+        void open()
+        {
+            const std::uint64_t configs[NUM_PERF_EVENTS] = {
+                PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES };
+
+            m_leader = -1;
+            for (int e = 0; e < NUM_PERF_EVENTS; ++e) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = configs[e];
+                attr.disabled = m_leader == -1 ? 1 : 0;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                    PERF_FORMAT_TOTAL_TIME_ENABLED |
+                    PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                const long fd = syscall(__NR_perf_event_open, &attr, 0, -1,
+                                        m_leader, 0);
+                if (fd == -1)
+                    continue;
+                m_fds[e] = int(fd);
+                if (ioctl(m_fds[e], PERF_EVENT_IOC_ID, &m_ids[e]) == -1)
+                    m_ids[e] = 0;
+                if (m_leader == -1)
+                    m_leader = m_fds[e];
+            }
+        }
+
+        void close()
+        {
+            for (int &fd : m_fds) {
+                if (fd != -1)
+                    ::close(fd);
+                fd = -1;
+            }
+            m_leader = -1;
+        }
+
+        void readGroup(PerfCounterValues &values) const
+        {
+            // layout for PERF_FORMAT_GROUP | PERF_FORMAT_ID | TOTAL_TIME_*
+            struct
+            {
+                std::uint64_t nr;
+                std::uint64_t timeEnabled;
+                std::uint64_t timeRunning;
+                struct
+                {
+                    std::uint64_t value;
+                    std::uint64_t id;
+                } entries[NUM_PERF_EVENTS];
+            } data;
+
+            if (read(m_leader, &data, sizeof(data)) <= 0)
+                return;
+
+            // scale up if the kernel had to multiplex the counters
+            const double scale = data.timeRunning == 0 ? 0.0 :
+                double(data.timeEnabled) / double(data.timeRunning);
+            for (std::uint64_t i = 0; i < data.nr && i < NUM_PERF_EVENTS; ++i) {
+                for (int e = 0; e < NUM_PERF_EVENTS; ++e) {
+                    if (m_fds[e] != -1 && m_ids[e] == data.entries[i].id) {
+                        values.counters[e] =
+                            double(data.entries[i].value) * scale;
+                    }
+                }
+            }
+        }
+#else
+        void open()
+        {
+            m_leader = -1;
+        }
+
+        void close()
+        {
+        }
+#endif
+
+        int m_fds[NUM_PERF_EVENTS];
+        std::uint64_t m_ids[NUM_PERF_EVENTS];
+        int m_leader;
+        std::chrono::steady_clock::time_point m_start;
+};
+
+/// Probe that records the hardware counters of every check, or the wall
+/// time if the counters are unavailable. Register it for a run:
+///
+///     cppqc::PerfCounterProbe probe;
+///     cppqc::ProbeRegistration registration(probe);
+///     cppqc::quickCheckOutput(MyProperty());
+///
+/// The counters are opened for the thread that creates the probe, which
+/// must be the thread running the checks.
+class PerfCounterProbe : public CheckProbe
+{
+    public:
+        bool available() const
+        {
+            return m_counters.available();
+        }
+
+        void start() override
+        {
+            m_counters.start();
+        }
+
+        void stop() override
+        {
+            const PerfCounterValues values = m_counters.stop();
+            bool anyCounter = false;
+            for (int e = 0; e < NUM_PERF_EVENTS; ++e) {
+                if (values.has(PerfEvent(e))) {
+                    recordMeasurement(perfEventName(PerfEvent(e)),
+                                      values[PerfEvent(e)]);
+                    anyCounter = true;
+                }
+            }
+            if (!anyCounter)
+                recordMeasurement("wall ns", values.wallNanoseconds);
+        }
+
+    private:
+        PerfCounters m_counters;
+};
+
+}
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_PERFORMANCE_H
+#define CPPQC_PERFORMANCE_H
+
+#include "Arbitrary.h"
+#include "Measurement.h"
+#include "Test.h"
+
+#include <limits>
+#include <vector>
+
+namespace cppqc {
+
+/// A property that searches for inputs on which the code under test is too
+/// slow. "cost" returns the cost of processing an input, either as wall
+/// time (see measureNanoseconds) or as an operation count. An input fails
+/// if its cost exceeds the threshold, so the normal shrinking minimizes
+/// the input while keeping its cost above the threshold. The result is a
+/// small reproducer of a performance cliff.
+///
+/// To reduce timing noise, the cost is measured several times and the
+/// median is compared against the threshold. Properties with a
+/// deterministic cost (operation counts) should override repetitions to
+/// return 1.
+template<class... T>
+class PerformanceProperty : public Property<T...>
+{
+    public:
+        explicit PerformanceProperty(double threshold) :
+            m_threshold(threshold),
+            m_lastFailureCost(std::numeric_limits<double>::quiet_NaN())
+        {
+        }
+
+        PerformanceProperty(double threshold, const Generator<T> &...g) :
+            Property<T...>(g...),
+            m_threshold(threshold),
+            m_lastFailureCost(std::numeric_limits<double>::quiet_NaN())
+        {
+        }
+
+        double threshold() const
+        {
+            return m_threshold;
+        }
+
+        /// Median cost of the input over several repetitions.
+        double measureCost(const T &...v) const
+        {
+            std::vector<double> costs;
+            const std::size_t n = std::max<std::size_t>(repetitions(), 1);
+            costs.reserve(n);
+            for (std::size_t i = 0; i < n; ++i)
+                costs.push_back(cost(v...));
+            return detail::median(std::move(costs));
+        }
+
+        /// Cost of the last input that exceeded the threshold. After a
+        /// failed run, this is the cost of the shrunk counterexample.
+        double lastFailureCost() const
+        {
+            return m_lastFailureCost;
+        }
+
+    protected:
+        virtual std::size_t repetitions() const
+        {
+            return 5;
+        }
+
+    private:
+        virtual double cost(const T &...) const = 0;
+
+        bool check(const T &...v) const override
+        {
+            const double c = measureCost(v...);
+            recordMeasurement("cost", c);
+            if (c > m_threshold) {
+                m_lastFailureCost = c;
+                return false;
+            }
+            return true;
+        }
+
+        const double m_threshold;
+        mutable double m_lastFailureCost;
+};
+
+/// Runs a performance property like quickCheckOutput and, if an input
+/// exceeded the threshold, reports the cost of the shrunk counterexample.
+template<class... T>
+Result quickCheckPerformance(const PerformanceProperty<T...> &prop,
+        std::ostream &out = std::cout,
+        std::size_t maxSuccess = 100,
+        std::size_t maxDiscarded = 0, std::size_t maxSize = 0,
+        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
+        SeedType seed = USE_DEFAULT_SEED)
+{
+    const Result result = quickCheckOutput(prop, out, maxSuccess,
+        maxDiscarded, maxSize, shrinkTimeout, seed);
+    if (result.result == QC_FAILURE) {
+        out << "Cost of the counterexample: " << prop.lastFailureCost()
+            << " (threshold " << prop.threshold() << ")" << std::endl;
+    }
+    return result;
+}
+
+}
+
+#endif
@@ -27,24 +27,254 @@
 #define CPPQC_PRETTY_PRINT_H
 
 #include "cxx-prettyprint.h"
+#include <cstddef>
+#include <cstdlib>
+#include <iterator>
+#include <ostream>
 #include <string>
 #include <sstream>
+#include <type_traits>
+#include <utility>
 
 namespace cppqc {
 
+    // Limits for printing counterexamples, so that a failure on a huge
+    // input does not format hundreds of megabytes into the log.
+    struct PrintLimits
+    {
+        // Containers with more elements show only their first and last
+        // elements and how many were left out. 0 means no limit.
+        std::size_t maxElements;
+
+        // The output of each argument is cut after this many bytes.
+        // 0 means no limit.
+        std::size_t maxBytes;
+
+        // If not empty, counterexamples are also written in full, in
+        // binary form, to this file (see BinaryDump).
+        std::string dumpFile;
+    };
+
+    // These environment variables overwrite the default print limits.
+    constexpr const char* CPPQUICKCHECK_PRINT_ELEMENTS_ENV =
+        "CPPQUICKCHECK_PRINT_ELEMENTS";
+    constexpr const char* CPPQUICKCHECK_PRINT_BYTES_ENV =
+        "CPPQUICKCHECK_PRINT_BYTES";
+    constexpr const char* CPPQUICKCHECK_DUMP_FILE_ENV =
+        "CPPQUICKCHECK_DUMP_FILE";
+
+    namespace detail {
+        inline std::size_t sizeFromEnv(const char *name, std::size_t def)
+        {
+            const char *value = std::getenv(name);
+            if (value == nullptr || *value == '\0')
+                return def;
+            char *end = nullptr;
+            const unsigned long long parsed = std::strtoull(value, &end, 10);
+            return *end == '\0' ? std::size_t(parsed) : def;
+        }
+
+        inline PrintLimits defaultPrintLimits()
+        {
+            PrintLimits limits;
+            limits.maxElements =
+                sizeFromEnv(CPPQUICKCHECK_PRINT_ELEMENTS_ENV, 200);
+            limits.maxBytes = sizeFromEnv(CPPQUICKCHECK_PRINT_BYTES_ENV,
+                                          64 * 1024);
+            const char *dumpFile = std::getenv(CPPQUICKCHECK_DUMP_FILE_ENV);
+            if (dumpFile != nullptr)
+                limits.dumpFile = dumpFile;
+            return limits;
+        }
+    }
+
+    // The limits used for all printing; change them to configure the
+    // output of counterexamples.
+    inline PrintLimits &printLimits()
+    {
+        static PrintLimits limits = detail::defaultPrintLimits();
+        return limits;
+    }
+
+    template <class T>
+    struct PrettyPrint;
+
+    namespace detail {
+        template <class T>
+        struct HasStreamingPrint
+        {
+        private:
+            template <class U>
+            static char test(decltype(&PrettyPrint<U>::print));
+            template <class U>
+            static long test(...);
+        public:
+            static const bool value = sizeof(test<T>(nullptr)) == 1;
+        };
+
+        // Specializations of PrettyPrint that only provide toString are
+        // still supported, but are formatted into a string first.
+        template <class T>
+        typename std::enable_if<HasStreamingPrint<T>::value>::type
+        prettyPrintTo(std::ostream &out, const T &x)
+        {
+            PrettyPrint<T>::print(out, x);
+        }
+
+        template <class T>
+        typename std::enable_if<!HasStreamingPrint<T>::value>::type
+        prettyPrintTo(std::ostream &out, const T &x)
+        {
+            out << PrettyPrint<T>::toString(x);
+        }
+
+        template <class T>
+        struct IsPairOrTuple : std::false_type {};
+
+        template <class T1, class T2>
+        struct IsPairOrTuple<std::pair<T1, T2>> : std::true_type {};
+
+        template <class... T>
+        struct IsPairOrTuple<std::tuple<T...>> : std::true_type {};
+
+        template <class T>
+        struct IsBoundedContainer : std::integral_constant<bool,
+            pretty_print::is_container<T>::value &&
+            !IsPairOrTuple<T>::value> {};
+
+        // Prints at most printLimits().maxElements elements: the first
+        // half and the last half, with the number of elements in between.
+        template <class C>
+        void printContainer(std::ostream &out, const C &c)
+        {
+            typedef pretty_print::delimiters<C, char> Delimiters;
+            const char *delimiter = Delimiters::values.delimiter != nullptr ?
+                Delimiters::values.delimiter : "";
+
+            using std::begin;
+            using std::end;
+            const std::size_t n = std::distance(begin(c), end(c));
+            const std::size_t limit = printLimits().maxElements;
+            const bool cut = limit != 0 && n > limit;
+            const std::size_t head = cut ? (limit + 1) / 2 : n;
+            const std::size_t tail = cut ? limit / 2 : 0;
+
+            if (Delimiters::values.prefix != nullptr)
+                out << Delimiters::values.prefix;
+            auto it = begin(c);
+            for (std::size_t i = 0; i < head && out; ++i, ++it) {
+                if (i > 0)
+                    out << delimiter;
+                prettyPrintTo(out, *it);
+            }
+            if (cut && out) {
+                const std::size_t skipped = n - head - tail;
+                out << delimiter << "... " << skipped << " more ...";
+                std::advance(it, skipped);
+                for (std::size_t i = 0; i < tail && out; ++i, ++it) {
+                    out << delimiter;
+                    prettyPrintTo(out, *it);
+                }
+            }
+            if (Delimiters::values.postfix != nullptr)
+                out << Delimiters::values.postfix;
+        }
+
+        template <class T>
+        typename std::enable_if<IsBoundedContainer<T>::value>::type
+        printValue(std::ostream &out, const T &x)
+        {
+            printContainer(out, x);
+        }
+
+        template <class T1, class T2>
+        void printValue(std::ostream &out, const std::pair<T1, T2> &x)
+        {
+            out << '(';
+            prettyPrintTo(out, x.first);
+            out << ", ";
+            prettyPrintTo(out, x.second);
+            out << ')';
+        }
+
+        template <class T>
+        typename std::enable_if<!IsBoundedContainer<T>::value>::type
+        printValue(std::ostream &out, const T &x)
+        {
+            out << x;
+        }
+
+        // Forwards at most maxBytes characters to the target and then
+        // fails, which stops further formatting into the stream.
+        class BoundedStreambuf : public std::streambuf
+        {
+        public:
+            BoundedStreambuf(std::streambuf *target, std::size_t maxBytes) :
+                m_target(target), m_left(maxBytes), m_truncated(false)
+            {
+            }
+
+            bool truncated() const
+            {
+                return m_truncated;
+            }
+
+        protected:
+            int_type overflow(int_type c) override
+            {
+                if (traits_type::eq_int_type(c, traits_type::eof()))
+                    return traits_type::not_eof(c);
+                if (m_left == 0) {
+                    m_truncated = true;
+                    return traits_type::eof();
+                }
+                --m_left;
+                return m_target->sputc(traits_type::to_char_type(c));
+            }
+
+            std::streamsize xsputn(const char *s, std::streamsize n) override
+            {
+                std::streamsize room = n;
+                if (std::size_t(n) > m_left) {
+                    room = std::streamsize(m_left);
+                    m_truncated = true;
+                }
+                m_left -= std::size_t(room);
+                return m_target->sputn(s, room);
+            }
+
+            int sync() override
+            {
+                return m_target->pubsync();
+            }
+
+        private:
+            std::streambuf *m_target;
+            std::size_t m_left;
+            bool m_truncated;
+        };
+    }
+
     // The default implementation falls back to the std::ofstream
     // implementation. Note that because of the usage of "cxx-prettyprint",
     // it can handle understands C++ containers, pairs and tuples.
+    // Containers are printed in a streaming fashion and abbreviated
+    // according to printLimits().
     //
     // Strings are quoted to improve readability.
     //
     template <class T>
     struct PrettyPrint
     {
+        static void print(std::ostream& out, const T& x)
+        {
+            detail::printValue(out, x);
+        }
+
         static std::string toString(const T& x)
         {
             std::ostringstream out;
-            out << x;
+            print(out, x);
             return out.str();
         }
     };
@@ -52,6 +282,11 @@ namespace cppqc {
     template <>
     struct PrettyPrint<std::string>
     {
+        static void print(std::ostream& out, const std::string& x)
+        {
+            out << '\"' << x << '\"';
+        }
+
         static std::string toString(const std::string& x)
         {
             return '\"' + x + '\"';
@@ -64,6 +299,24 @@ namespace cppqc {
         return PrettyPrint<T>::toString(x);
     }
 
+    // Streams x to out, cut after printLimits().maxBytes bytes.
+    template <class T>
+    void prettyPrint(std::ostream& out, const T& x)
+    {
+        const std::size_t maxBytes = printLimits().maxBytes;
+        if (maxBytes == 0 || out.rdbuf() == nullptr) {
+            detail::prettyPrintTo(out, x);
+            return;
+        }
+
+        detail::BoundedStreambuf buf(out.rdbuf(), maxBytes);
+        std::ostream bounded(&buf);
+        bounded.copyfmt(out);
+        detail::prettyPrintTo(bounded, x);
+        if (buf.truncated())
+            out << " ... (cut after " << maxBytes << " bytes)";
+    }
+
 }
 
 #endif
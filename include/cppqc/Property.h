@@ -28,6 +28,11 @@
 
 #include "Generator.h"
 #include "PrettyPrint.h"
+#include "BinaryDump.h"
+
+#include <fstream>
+#include <ostream>
+#include <tuple>
 
 namespace cppqc {
 
@@ -35,12 +40,27 @@ namespace detail {
     struct null_type {};
 }
 
+enum ShrinkStrategy
+{
+    SHRINK_TREES,   // along the shrink trees of the generators
+    SHRINK_CHOICES  // on the recorded random choices (see ChoiceShrink.h)
+};
+
 class PropertyBase
 {
     public:
         // By default, it is expected that every check passes.
         virtual bool expect() const { return true; }
 
+        // How the input of a failing check is shrunk.
+        virtual ShrinkStrategy shrinkStrategy() const { return SHRINK_TREES; }
+
+        // Whether inputs that were checked before are skipped instead of
+        // checked again (see InputFilter.h). Needs a BinaryDump for the
+        // input types; worth it if checks are expensive and the
+        // generators often repeat themselves at small sizes.
+        virtual bool skipDuplicates() const { return false; }
+
         // Should be overwriten by subclasses, as the default
         // implementation is compiler dependent.
         // (However, in practice, gcc and clang produce useful defaults.)
@@ -69,10 +89,23 @@ class Property : public PropertyBase
         {
             return m_gen.unGen(rng, size);
         }
+        ShrinkTree<Input> generateInputTree(RngEngine &rng,
+                std::size_t size) const
+        {
+            return m_gen.unGenTree(rng, size);
+        }
         std::vector<Input> shrinkInput(const Input &in) const
         {
             return m_gen.shrink(in);
         }
+        std::size_t enumInputSize(std::size_t depth) const
+        {
+            return m_gen.enumSize(depth);
+        }
+        Input enumInput(std::size_t index, std::size_t depth) const
+        {
+            return m_gen.enumAt(index, depth);
+        }
         bool trivialInput(const Input &in) const
         {
             return trivial(std::get<0>(in), std::get<1>(in),
@@ -125,10 +158,23 @@ class Property<T0, detail::null_type, detail::null_type, detail::null_type,
         {
             return m_gen.unGen(rng, size);
         }
+        ShrinkTree<Input> generateInputTree(RngEngine &rng,
+                std::size_t size) const
+        {
+            return m_gen.unGenTree(rng, size);
+        }
         std::vector<Input> shrinkInput(const Input &in) const
         {
             return m_gen.shrink(in);
         }
+        std::size_t enumInputSize(std::size_t depth) const
+        {
+            return m_gen.enumSize(depth);
+        }
+        Input enumInput(std::size_t index, std::size_t depth) const
+        {
+            return m_gen.enumAt(index, depth);
+        }
         bool trivialInput(const Input &in) const
         {
             return trivial(std::get<0>(in));
@@ -176,10 +222,23 @@ class Property<T0, T1, detail::null_type, detail::null_type,
         {
             return m_gen.unGen(rng, size);
         }
+        ShrinkTree<Input> generateInputTree(RngEngine &rng,
+                std::size_t size) const
+        {
+            return m_gen.unGenTree(rng, size);
+        }
         std::vector<Input> shrinkInput(const Input &in) const
         {
             return m_gen.shrink(in);
         }
+        std::size_t enumInputSize(std::size_t depth) const
+        {
+            return m_gen.enumSize(depth);
+        }
+        Input enumInput(std::size_t index, std::size_t depth) const
+        {
+            return m_gen.enumAt(index, depth);
+        }
         bool trivialInput(const Input &in) const
         {
             return trivial(std::get<0>(in), std::get<1>(in));
@@ -228,10 +287,23 @@ class Property<T0, T1, T2, detail::null_type, detail::null_type> :
         {
             return m_gen.unGen(rng, size);
         }
+        ShrinkTree<Input> generateInputTree(RngEngine &rng,
+                std::size_t size) const
+        {
+            return m_gen.unGenTree(rng, size);
+        }
         std::vector<Input> shrinkInput(const Input &in) const
         {
             return m_gen.shrink(in);
         }
+        std::size_t enumInputSize(std::size_t depth) const
+        {
+            return m_gen.enumSize(depth);
+        }
+        Input enumInput(std::size_t index, std::size_t depth) const
+        {
+            return m_gen.enumAt(index, depth);
+        }
         bool trivialInput(const Input &in) const
         {
             return trivial(std::get<0>(in), std::get<1>(in),
@@ -283,10 +355,23 @@ class Property<T0, T1, T2, T3, detail::null_type> : public PropertyBase
         {
             return m_gen.unGen(rng, size);
         }
+        ShrinkTree<Input> generateInputTree(RngEngine &rng,
+                std::size_t size) const
+        {
+            return m_gen.unGenTree(rng, size);
+        }
         std::vector<Input> shrinkInput(const Input &in) const
         {
             return m_gen.shrink(in);
         }
+        std::size_t enumInputSize(std::size_t depth) const
+        {
+            return m_gen.enumSize(depth);
+        }
+        Input enumInput(std::size_t index, std::size_t depth) const
+        {
+            return m_gen.enumAt(index, depth);
+        }
         bool trivialInput(const Input &in) const
         {
             return trivial(std::get<0>(in), std::get<1>(in),
@@ -329,131 +414,43 @@ class Property<T0, T1, T2, T3, detail::null_type> : public PropertyBase
 // classifyWith
 // trivializeWith
 
-    template<class T0>
-    std::ostream &printInput(std::ostream &out, const std::tuple<T0> &in)
-    {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << std::flush;
-    }
-
-    template<class T0, class T1>
-    std::ostream &printInput(std::ostream &out, const std::tuple<T0, T1> &in)
-    {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << std::flush;
-    }
-
-    template<class T0, class T1, class T2>
-    std::ostream &printInput(std::ostream &out,
-            const std::tuple<T0, T1, T2> &in)
-    {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << "  2: " << prettyPrint(std::get<2>(in)) << '\n'
-                   << std::flush;
-    }
-
-    template<class T0, class T1, class T2, class T3>
-    std::ostream &printInput(std::ostream &out,
-            const std::tuple<T0, T1, T2, T3> &in)
-    {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << "  2: " << prettyPrint(std::get<2>(in)) << '\n'
-                   << "  3: " << prettyPrint(std::get<3>(in)) << '\n'
-                   << std::flush;
-    }
-
-    template<class T0, class T1, class T2, class T3, class T4>
-    std::ostream &printInput(std::ostream &out,
-            const std::tuple<T0, T1, T2, T3, T4> &in)
-    {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << "  2: " << prettyPrint(std::get<2>(in)) << '\n'
-                   << "  3: " << prettyPrint(std::get<3>(in)) << '\n'
-                   << "  4: " << prettyPrint(std::get<4>(in)) << '\n'
-                   << std::flush;
-    }
-
-    template<class T0, class T1, class T2, class T3, class T4, class T5>
-    std::ostream &printInput(std::ostream &out,
-            const std::tuple<T0, T1, T2, T3, T4, T5> &in)
-    {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << "  2: " << prettyPrint(std::get<2>(in)) << '\n'
-                   << "  3: " << prettyPrint(std::get<3>(in)) << '\n'
-                   << "  4: " << prettyPrint(std::get<4>(in)) << '\n'
-                   << "  5: " << prettyPrint(std::get<5>(in)) << '\n'
-                   << std::flush;
-    }
-
-    template<class T0, class T1, class T2, class T3, class T4,
-        class T5, class T6>
-    std::ostream &printInput(std::ostream &out,
-            const std::tuple<T0, T1, T2, T3, T4, T5, T6> &in)
-    {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << "  2: " << prettyPrint(std::get<2>(in)) << '\n'
-                   << "  3: " << prettyPrint(std::get<3>(in)) << '\n'
-                   << "  4: " << prettyPrint(std::get<4>(in)) << '\n'
-                   << "  5: " << prettyPrint(std::get<5>(in)) << '\n'
-                   << "  6: " << prettyPrint(std::get<6>(in)) << '\n'
-                   << std::flush;
-    }
-
-    template<class T0, class T1, class T2, class T3, class T4,
-        class T5, class T6, class T7>
-    std::ostream &printInput(std::ostream &out,
-            const std::tuple<T0, T1, T2, T3, T4, T5, T6, T7> &in)
-    {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << "  2: " << prettyPrint(std::get<2>(in)) << '\n'
-                   << "  3: " << prettyPrint(std::get<3>(in)) << '\n'
-                   << "  4: " << prettyPrint(std::get<4>(in)) << '\n'
-                   << "  5: " << prettyPrint(std::get<5>(in)) << '\n'
-                   << "  6: " << prettyPrint(std::get<6>(in)) << '\n'
-                   << "  7: " << prettyPrint(std::get<7>(in)) << '\n'
-                   << std::flush;
+    namespace detail {
+        template<class... T, std::size_t... I>
+        void printArguments(std::ostream &out, const std::tuple<T...> &in,
+                            IndexList<I...>)
+        {
+            const int expand[] = { 0, ((out << "  " << I << ": "),
+                prettyPrint(out, std::get<I>(in)), (out << '\n'), 0)... };
+            (void) expand;
+        }
     }
 
-    template<class T0, class T1, class T2, class T3, class T4,
-        class T5, class T6, class T7, class T8>
-    std::ostream &printInput(std::ostream &out,
-            const std::tuple<T0, T1, T2, T3, T4, T5, T6, T7, T8> &in)
+    // Prints every argument on its own line, abbreviated according to
+    // printLimits().
+    template<class... T>
+    std::ostream &printInput(std::ostream &out, const std::tuple<T...> &in)
     {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << "  2: " << prettyPrint(std::get<2>(in)) << '\n'
-                   << "  3: " << prettyPrint(std::get<3>(in)) << '\n'
-                   << "  4: " << prettyPrint(std::get<4>(in)) << '\n'
-                   << "  5: " << prettyPrint(std::get<5>(in)) << '\n'
-                   << "  6: " << prettyPrint(std::get<6>(in)) << '\n'
-                   << "  7: " << prettyPrint(std::get<7>(in)) << '\n'
-                   << "  8: " << prettyPrint(std::get<8>(in)) << '\n'
-                   << std::flush;
+        detail::printArguments(out, in,
+            typename detail::MakeIndexList<sizeof...(T)>::type());
+        return out << std::flush;
     }
 
-    template<class T0, class T1, class T2, class T3, class T4,
-        class T5, class T6, class T7, class T8, class T9>
-    std::ostream &printInput(std::ostream &out,
-            const std::tuple<T0, T1, T2, T3, T4, T5, T6, T7, T8, T9> &in)
+    // Writes the input in binary form to printLimits().dumpFile, if set,
+    // and tells where it went.
+    template<class... T>
+    std::ostream &dumpInput(std::ostream &out, const std::tuple<T...> &in)
     {
-        return out << "  0: " << prettyPrint(std::get<0>(in)) << '\n'
-                   << "  1: " << prettyPrint(std::get<1>(in)) << '\n'
-                   << "  2: " << prettyPrint(std::get<2>(in)) << '\n'
-                   << "  3: " << prettyPrint(std::get<3>(in)) << '\n'
-                   << "  4: " << prettyPrint(std::get<4>(in)) << '\n'
-                   << "  5: " << prettyPrint(std::get<5>(in)) << '\n'
-                   << "  6: " << prettyPrint(std::get<6>(in)) << '\n'
-                   << "  7: " << prettyPrint(std::get<7>(in)) << '\n'
-                   << "  8: " << prettyPrint(std::get<8>(in)) << '\n'
-                   << "  9: " << prettyPrint(std::get<9>(in)) << '\n'
-                   << std::flush;
+        const std::string &path = printLimits().dumpFile;
+        if (path.empty())
+            return out;
+        if (!BinaryDump<std::tuple<T...>>::supported) {
+            return out << "(Input not dumped: no BinaryDump for its types)\n";
+        }
+        std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+        detail::dumpTo(file, in);
+        if (!file)
+            return out << "(Failed to dump the input to " << path << ")\n";
+        return out << "(Full input dumped to " << path << ")\n";
     }
 
 }
@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_SHRINK_TREE_H
+#define CPPQC_SHRINK_TREE_H
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace cppqc {
+
+template<class T>
+class ShrinkTree;
+
+namespace detail {
+    template<class T>
+    struct ExpandConcept
+    {
+        virtual ~ExpandConcept()
+        {
+        }
+        virtual std::vector<ShrinkTree<T>> expand(const T &,
+            const std::shared_ptr<const ExpandConcept> &self) const = 0;
+    };
+
+    template<class T, class F>
+    struct ExpandModel : ExpandConcept<T>
+    {
+        explicit ExpandModel(F f) : m_obj(std::move(f))
+        {
+        }
+
+        std::vector<ShrinkTree<T>> expand(const T &x,
+            const std::shared_ptr<const ExpandConcept<T>> &self) const override
+        {
+            return m_obj(x, self);
+        }
+
+        const F m_obj;
+    };
+}
+
+/// A generated value together with all the ways it can be shrunk: the
+/// children of a tree are the shrink candidates of its value, each with
+/// its own candidates, and so on. The children are only computed when
+/// asked for, and are not cached.
+///
+/// The candidates of a value are computed by an expand function, which
+/// gets the value passed in, so a combinator that builds a value from
+/// others only keeps the expand functions of its parts, not copies of
+/// their values. Expand functions are shared between trees: a function
+/// also gets passed the pointer it is called through, so that children
+/// which shrink the same way as their parent can reuse it.
+template<class T>
+class ShrinkTree
+{
+    public:
+        typedef std::shared_ptr<const detail::ExpandConcept<T>> Expand;
+
+        /// A tree without children, if no expand function is given.
+        explicit ShrinkTree(T value, Expand expand = Expand()) :
+            m_value(std::move(value)), m_expand(std::move(expand))
+        {
+        }
+
+        const T &value() const
+        {
+            return m_value;
+        }
+
+        T &value()
+        {
+            return m_value;
+        }
+
+        const Expand &expand() const
+        {
+            return m_expand;
+        }
+
+        std::vector<ShrinkTree> children() const
+        {
+            if (!m_expand)
+                return std::vector<ShrinkTree>();
+            return m_expand->expand(m_value, m_expand);
+        }
+
+    private:
+        T m_value;
+        Expand m_expand;
+};
+
+/// Wraps a function object
+///
+///     std::vector<ShrinkTree<T>> f(const T &value, const Expand &self)
+///
+/// as an expand function. "self" is the pointer f is called through.
+template<class T, class F>
+typename ShrinkTree<T>::Expand makeExpand(F f)
+{
+    return std::make_shared<const detail::ExpandModel<T, F>>(std::move(f));
+}
+
+namespace detail {
+    template<class T, class Shrink>
+    struct UnfoldExpand
+    {
+        typedef typename ShrinkTree<T>::Expand Expand;
+
+        std::vector<ShrinkTree<T>> operator()(const T &x,
+                                              const Expand &self) const
+        {
+            std::vector<T> shrinks = shrink(x);
+            std::vector<ShrinkTree<T>> ret;
+            ret.reserve(shrinks.size());
+            for (auto &&s : shrinks) // not T &, for std::vector<bool>
+                ret.emplace_back(std::move(s), self);
+            return ret;
+        }
+
+        Shrink shrink;
+    };
+
+    template<class T, class U, class F>
+    struct MapExpand
+    {
+        typedef typename ShrinkTree<T>::Expand Expand;
+
+        std::vector<ShrinkTree<T>> operator()(const T &, const Expand &) const
+        {
+            std::vector<ShrinkTree<U>> from = source.children();
+            std::vector<ShrinkTree<T>> ret;
+            ret.reserve(from.size());
+            for (ShrinkTree<U> &u : from) {
+                T t = f(u.value());
+                ret.emplace_back(std::move(t),
+                                 makeExpand<T>(MapExpand{std::move(u), f}));
+            }
+            return ret;
+        }
+
+        ShrinkTree<U> source;
+        F f;
+    };
+
+    template<class T, class U1, class U2, class F>
+    struct CombineExpand
+    {
+        typedef typename ShrinkTree<T>::Expand Expand;
+
+        std::vector<ShrinkTree<T>> operator()(const T &, const Expand &) const
+        {
+            std::vector<ShrinkTree<U1>> from1 = source1.children();
+            std::vector<ShrinkTree<U2>> from2 = source2.children();
+            std::vector<ShrinkTree<T>> ret;
+            ret.reserve(from1.size() + from2.size());
+            for (ShrinkTree<U1> &u1 : from1) {
+                T t = f(u1.value(), source2.value());
+                ret.emplace_back(std::move(t), makeExpand<T>(
+                    CombineExpand{std::move(u1), source2, f}));
+            }
+            for (ShrinkTree<U2> &u2 : from2) {
+                T t = f(source1.value(), u2.value());
+                ret.emplace_back(std::move(t), makeExpand<T>(
+                    CombineExpand{source1, std::move(u2), f}));
+            }
+            return ret;
+        }
+
+        ShrinkTree<U1> source1;
+        ShrinkTree<U2> source2;
+        F f;
+    };
+
+    // Wraps the expand functions of the children like the one of the
+    // parent; children that expand like their parent reuse its wrapper.
+    template<class T, class Wrapper>
+    std::vector<ShrinkTree<T>> wrapChildren(std::vector<ShrinkTree<T>> in,
+            const Wrapper &wrapper,
+            const typename ShrinkTree<T>::Expand &self)
+    {
+        for (ShrinkTree<T> &c : in) {
+            if (!c.expand())
+                continue;
+            typename ShrinkTree<T>::Expand expand = c.expand() ==
+                wrapper.expand ? self : makeExpand<T>(Wrapper(wrapper,
+                                                              c.expand()));
+            c = ShrinkTree<T>(std::move(c.value()), std::move(expand));
+        }
+        return in;
+    }
+
+    template<class T, class Pred>
+    struct FilterExpand
+    {
+        typedef typename ShrinkTree<T>::Expand Expand;
+
+        FilterExpand(Expand expand, Pred pred) :
+            expand(std::move(expand)), pred(std::move(pred))
+        {
+        }
+
+        FilterExpand(const FilterExpand &other, Expand expand) :
+            expand(std::move(expand)), pred(other.pred)
+        {
+        }
+
+        std::vector<ShrinkTree<T>> operator()(const T &x,
+                                              const Expand &self) const
+        {
+            std::vector<ShrinkTree<T>> ret = expand->expand(x, expand);
+            ret.erase(std::remove_if(ret.begin(), ret.end(),
+                [this](const ShrinkTree<T> &c) { return !pred(c.value()); }),
+                ret.end());
+            return wrapChildren(std::move(ret), *this, self);
+        }
+
+        Expand expand;
+        Pred pred;
+    };
+
+    // keeps an object alive as long as any node of the tree needs it
+    template<class T>
+    struct RetainExpand
+    {
+        typedef typename ShrinkTree<T>::Expand Expand;
+
+        RetainExpand(Expand expand, std::shared_ptr<const void> owner) :
+            expand(std::move(expand)), owner(std::move(owner))
+        {
+        }
+
+        RetainExpand(const RetainExpand &other, Expand expand) :
+            expand(std::move(expand)), owner(other.owner)
+        {
+        }
+
+        std::vector<ShrinkTree<T>> operator()(const T &x,
+                                              const Expand &self) const
+        {
+            return wrapChildren(expand->expand(x, expand), *this, self);
+        }
+
+        Expand expand;
+        std::shared_ptr<const void> owner;
+    };
+}
+
+/// Builds the tree of a value from a classic shrink function, which
+/// returns the candidates of a value: std::vector<T> shrink(const T &).
+/// All nodes share one expand function.
+template<class T, class Shrink>
+ShrinkTree<T> unfoldShrinkTree(T value, Shrink shrink)
+{
+    return ShrinkTree<T>(std::move(value), makeExpand<T>(
+        detail::UnfoldExpand<T, Shrink>{shrink}));
+}
+
+/// Applies f to every value of the tree.
+template<class T, class U, class F>
+ShrinkTree<T> mapShrinkTree(ShrinkTree<U> tree, F f)
+{
+    T value = f(tree.value());
+    return ShrinkTree<T>(std::move(value), makeExpand<T>(
+        detail::MapExpand<T, U, F>{std::move(tree), f}));
+}
+
+/// Combines two trees into one whose values are f(u1, u2). Shrinks the
+/// first value, then the second, keeping the other one unchanged.
+template<class T, class U1, class U2, class F>
+ShrinkTree<T> combineShrinkTrees(ShrinkTree<U1> tree1, ShrinkTree<U2> tree2,
+                                 F f)
+{
+    T value = f(tree1.value(), tree2.value());
+    return ShrinkTree<T>(std::move(value), makeExpand<T>(
+        detail::CombineExpand<T, U1, U2, F>{std::move(tree1),
+                                            std::move(tree2), f}));
+}
+
+/// Removes every subtree whose value does not satisfy pred, except for
+/// the root.
+template<class T, class Pred>
+ShrinkTree<T> filterShrinkTree(ShrinkTree<T> tree, Pred pred)
+{
+    if (!tree.expand())
+        return tree;
+    typename ShrinkTree<T>::Expand expand = makeExpand<T>(
+        detail::FilterExpand<T, Pred>(tree.expand(), std::move(pred)));
+    return ShrinkTree<T>(std::move(tree.value()), std::move(expand));
+}
+
+/// Returns the same tree, which keeps the owner alive until no node needs
+/// it anymore.
+template<class T>
+ShrinkTree<T> retainShrinkTree(ShrinkTree<T> tree,
+                               std::shared_ptr<const void> owner)
+{
+    if (!tree.expand())
+        return tree;
+    typename ShrinkTree<T>::Expand expand = makeExpand<T>(
+        detail::RetainExpand<T>(tree.expand(), std::move(owner)));
+    return ShrinkTree<T>(std::move(tree.value()), std::move(expand));
+}
+
+}
+
+#endif
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2010, Gregory Rogers All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CPPQC_TARGETED_H
+#define CPPQC_TARGETED_H
+
+#include "Arbitrary.h"
+#include "Test.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+
+// Targeted property-based testing: instead of sampling inputs blindly, the
+// runner searches for inputs that maximize a utility the property reports
+// for each input, e.g. the depth a queue reached or the number of hash
+// collisions. Bugs that only show in states far out on that scale are then
+// found after far fewer tests than by random testing.
+//
+// The search starts from the best of a few random inputs and moves
+// between neighbouring inputs. The neighbours of an input are its shrink
+// candidates (see ShrinkTree), and its "grow" mutation: the input is
+// generated again one size larger from the random choices it was
+// generated from (see RngEngine::record), with one of them perturbed.
+// Every input visited is checked, and a failing input is shrunk as usual.
+
+namespace cppqc {
+
+/// A property that reports how close an input comes to the states the
+/// property is after. "utility" is only called on inputs that passed the
+/// check; higher is closer.
+template<class... T>
+class TargetedProperty : public Property<T...>
+{
+    public:
+        typedef typename Property<T...>::Input Input;
+
+        TargetedProperty()
+        {
+        }
+
+        TargetedProperty(const Generator<T> &...g) : Property<T...>(g...)
+        {
+        }
+
+        double utilityInput(const Input &in) const
+        {
+            return utilityInput(in,
+                typename detail::MakeIndexList<sizeof...(T)>::type());
+        }
+
+    private:
+        virtual double utility(const T &...) const = 0;
+
+        template<std::size_t... I>
+        double utilityInput(const Input &in, detail::IndexList<I...>) const
+        {
+            return utility(std::get<I>(in)...);
+        }
+};
+
+enum TargetedSearch
+{
+    // move to a neighbour only if its utility is at least as high
+    HILL_CLIMBING,
+    // also move to worse neighbours, the less likely the worse they are
+    // and the closer the search is to the end of its budget
+    SIMULATED_ANNEALING
+};
+
+struct TargetedResult : Result
+{
+    double maxUtility; // of the inputs that passed
+};
+
+namespace detail {
+    template<class Input>
+    struct TargetedCandidate
+    {
+        TargetedCandidate(ShrinkTree<Input> tree, Choices choices,
+                          bool generated, std::size_t size) :
+            tree(std::move(tree)), choices(std::move(choices)),
+            generated(generated), size(size), utility(0)
+        {
+        }
+
+        ShrinkTree<Input> tree;
+        // the choices the input was generated from or, if it was reached
+        // by shrinking, those of the input it was shrunk from
+        Choices choices;
+        bool generated;
+        std::size_t size;
+        double utility;
+    };
+
+    // Generates an input from the given choices, drawing random numbers
+    // once they are used up, and records the choices it was generated
+    // from.
+    template<class... T>
+    TargetedCandidate<std::tuple<T...>> generateCandidate(
+            const TargetedProperty<T...> &prop, RngEngine &rng,
+            const Choices &from, std::size_t size)
+    {
+        RngEngine gen(rng());
+        Choices choices;
+        gen.replay(&from, REPLAY_RANDOM);
+        gen.record(&choices);
+        ShrinkTree<std::tuple<T...>> tree = prop.generateInputTree(gen, size);
+        return TargetedCandidate<std::tuple<T...>>(std::move(tree),
+            std::move(choices), true, size);
+    }
+
+    // Replaces the choice by a random one or moves it up or down by a
+    // random amount, from one to half of the range, without wrapping
+    // around.
+    inline std::uint32_t perturbChoice(std::uint32_t choice, RngEngine &rng)
+    {
+        if (rng() & 1)
+            return static_cast<std::uint32_t>(rng());
+        const std::uint32_t delta = std::max<std::uint32_t>(
+            static_cast<std::uint32_t>(rng() >> (1 + rng() % 31)), 1);
+        if (rng() & 1)
+            return choice > 0xffffffffu - delta ? 0xffffffffu : choice + delta;
+        return choice < delta ? 0 : choice - delta;
+    }
+
+    template<class... T>
+    TargetedCandidate<std::tuple<T...>> neighbour(
+            const TargetedProperty<T...> &prop,
+            const TargetedCandidate<std::tuple<T...>> &from, RngEngine &rng,
+            std::size_t maxSize)
+    {
+        typedef std::tuple<T...> Input;
+
+        // a quarter of the neighbours are shrinks, the rest grow
+        if (rng() % 4 == 0) {
+            std::vector<ShrinkTree<Input>> shrinks = from.tree.children();
+            if (!shrinks.empty()) {
+                return TargetedCandidate<Input>(
+                    std::move(shrinks[rng() % shrinks.size()]), from.choices,
+                    false, from.size);
+            }
+        }
+
+        Choices grown = from.choices;
+        if (!grown.empty()) {
+            std::uint32_t &choice = grown[rng() % grown.size()];
+            choice = perturbChoice(choice, rng);
+        }
+        return generateCandidate(prop, rng, grown,
+                                 std::min(from.size + 1, maxSize));
+    }
+}
+
+/// Checks a targeted property on maxSuccess inputs: the first tenth are
+/// random inputs of growing size, the rest are found by searching from the
+/// best of them for inputs of higher utility. Fails like quickCheckReport
+/// as soon as an input fails, and otherwise returns the highest utility
+/// reached. The seed reproduces the whole search; a failing input found by
+/// the search has no test case id of its own.
+template<class... T, class Reporter>
+TargetedResult quickCheckTargetedReport(const TargetedProperty<T...> &prop,
+        Reporter &reporter,
+        std::size_t maxSuccess = 100,
+        std::size_t maxDiscarded = 0, std::size_t maxSize = 0,
+        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
+        SeedType seed = USE_DEFAULT_SEED,
+        TargetedSearch search = SIMULATED_ANNEALING)
+{
+    typedef std::tuple<T...> Input;
+    typedef detail::TargetedCandidate<Input> Candidate;
+
+    reporter.start(prop);
+
+    const detail::RunState state = detail::initialRunState(maxSuccess,
+        maxDiscarded, maxSize, seed);
+    TargetedResult ret;
+    static_cast<Result &>(ret) = detail::resultOf(state, QC_SUCCESS, 0);
+    ret.maxUtility = -std::numeric_limits<double>::infinity();
+
+    const std::size_t numRandom = std::max<std::size_t>(maxSuccess / 10, 1);
+    double minUtility = std::numeric_limits<double>::infinity();
+    std::unique_ptr<Candidate> current;
+    std::size_t numTests = 0, numDiscarded = 0;
+    RngEngine rng(static_cast<RngEngine::result_type>(state.seed));
+    std::uniform_real_distribution<double> coin(0, 1);
+    while (numTests < maxSuccess) {
+        std::unique_ptr<Candidate> next;
+        try {
+            if (numTests < numRandom || !current) {
+                next.reset(new Candidate(detail::generateCandidate(prop, rng,
+                    Choices(), numTests * state.maxSize / numRandom)));
+            } else {
+                next.reset(new Candidate(detail::neighbour(prop, *current,
+                    rng, state.maxSize)));
+            }
+        } catch (...) {
+            if (++numDiscarded >= state.maxDiscarded) {
+                reporter.gaveUp(numTests);
+                ret.result = QC_GAVE_UP;
+                ret.numTests = numTests;
+                return ret;
+            }
+            continue;
+        }
+        ++numTests;
+
+        const Input &in = next->tree.value();
+        bool success = false;
+        try {
+            success = prop.checkInput(in);
+        } catch (...) {
+            reporter.exceptionCaught();
+        }
+
+        if (!success) {
+            const detail::ShrinkResult<Input> shrinkRes =
+                prop.shrinkStrategy() == SHRINK_CHOICES && next->generated ?
+                detail::doShrinkChoices(prop, next->choices, next->size, in,
+                                        shrinkTimeout, reporter) :
+                detail::doShrink(prop, next->tree, shrinkTimeout, reporter);
+            std::ostringstream reproduction;
+            reproduction << CPPQUICKCHECK_SEED_ENV << '=' << state.seed
+                         << ", which repeats the whole search";
+            ret.failedTestCase = TestCaseId();
+            ret.failedTestCase.reproduction = reproduction.str();
+            reporter.failed(prop, numTests, shrinkRes.numShrinks,
+                            shrinkRes.input, ret.failedTestCase);
+
+            ret.result = prop.expect() ? QC_FAILURE : QC_SUCCESS;
+            ret.numTests = numTests;
+            ret.numShrinks = shrinkRes.numShrinks;
+            ret.numShrinkEvaluations = shrinkRes.numEvaluations;
+            ret.usedSize = next->size;
+            ret.failedChoices = shrinkRes.choices;
+            return ret;
+        }
+
+        next->utility = prop.utilityInput(in);
+        ret.maxUtility = std::max(ret.maxUtility, next->utility);
+        minUtility = std::min(minUtility, next->utility);
+
+        bool accept = !current || next->utility >= current->utility;
+        if (!accept && numTests > numRandom && search == SIMULATED_ANNEALING) {
+            // the temperature falls from the spread of the utilities seen
+            // so far to zero over the search
+            const double temperature = 0.1 * (ret.maxUtility - minUtility) *
+                double(maxSuccess - numTests) / double(maxSuccess - numRandom);
+            accept = temperature > 0 && coin(rng) <
+                std::exp((next->utility - current->utility) / temperature);
+        }
+        if (accept)
+            current = std::move(next);
+    }
+
+    ret.result = prop.expect() ? QC_SUCCESS : QC_NO_EXPECTED_FAILURE;
+    ret.numTests = numTests;
+    reporter.passed(prop, 0, ret);
+    return ret;
+}
+
+/// quickCheckTargetedReport with the report written to a stream, followed
+/// by the highest utility reached if any input passed.
+template<class... T>
+TargetedResult quickCheckTargeted(const TargetedProperty<T...> &prop,
+        std::ostream &out = std::cout,
+        std::size_t maxSuccess = 100,
+        std::size_t maxDiscarded = 0, std::size_t maxSize = 0,
+        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
+        SeedType seed = USE_DEFAULT_SEED,
+        TargetedSearch search = SIMULATED_ANNEALING)
+{
+    StreamReporter reporter(out);
+    const TargetedResult ret = quickCheckTargetedReport(prop, reporter,
+        maxSuccess, maxDiscarded, maxSize, shrinkTimeout, seed, search);
+    if (!std::isinf(ret.maxUtility))
+        out << "(highest utility " << ret.maxUtility << ")" << std::endl;
+    return ret;
+}
+
+}
+
+#endif
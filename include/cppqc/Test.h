@@ -27,14 +27,24 @@
 #define CPPQC_TEST_H
 
 #include "Property.h"
+#include "Measurement.h"
+#include "ChoiceShrink.h"
+#include "InputFilter.h"
 
 #include <map>
 #include <string>
 #include <iostream>
 #include <iomanip>
 #include <ostream>
+#include <sstream>
+#include <stdexcept>
 #include <limits>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
 
 namespace cppqc {
 
@@ -50,6 +60,16 @@ constexpr SeedType USE_DEFAULT_SEED = std::numeric_limits<uint32_t>::max();
 // if a seed has been explicitly set, it will will be used.
 constexpr const char* CPPQUICKCHECK_SEED_ENV = "CPPQUICKCHECK_SEED";
 
+// If this environment variable is set to "seed:index:size", as printed
+// for a failing test, only that test case is generated and checked, which
+// reproduces a failure without running all tests before it.
+constexpr const char* CPPQUICKCHECK_REPLAY_ENV = "CPPQUICKCHECK_REPLAY";
+
+// If this environment variable is set to the path of an input found by a
+// fuzzer (see Fuzz.h), only the test case decoded from it is checked, and
+// shrunk if it fails.
+constexpr const char* CPPQUICKCHECK_FUZZ_INPUT_ENV = "CPPQUICKCHECK_FUZZ_INPUT";
+
 enum ResultType
 {
     QC_SUCCESS, // All tests succeeded
@@ -58,34 +78,47 @@ enum ResultType
     QC_NO_EXPECTED_FAILURE // The property was expected to fail but didn't
 };
 
+// Identifies a single test case: its input is generated from a random
+// number generator derived from all three values, independently of the
+// test cases before it.
+struct TestCaseId
+{
+    SeedType seed;
+    std::size_t index; // counts passed, discarded and duplicate test cases
+    std::size_t size;
+    // Set for test cases that the three values above do not reproduce
+    // (e.g., decoded from a fuzzer's data): how to reproduce them instead.
+    std::string reproduction;
+};
+
+inline std::ostream &operator<<(std::ostream &out, const TestCaseId &id)
+{
+    return out << id.seed << ':' << id.index << ':' << id.size;
+}
+
 struct Result
 {
     ResultType result;
     std::size_t numTests;
+    // inputs skipped as checked before (see PropertyBase::skipDuplicates)
+    std::size_t numDuplicates;
     std::multimap<std::size_t, std::string> labels;
     SeedType seed;
 
+    // values reported by probes or recordMeasurement, by label and by
+    // size bucket (see sizeBucket)
+    std::map<std::string, MeasurementTable> measurements;
+    std::map<std::size_t, MeasurementTable> measurementsBySize;
+
     // only used if result is QC_FAILURE
     std::size_t numShrinks;
+    std::size_t numShrinkEvaluations; // shrink candidates checked
     std::size_t usedSize;
+    TestCaseId failedTestCase;
+    // the shrunk choices, if the property shrinks with SHRINK_CHOICES
+    Choices failedChoices;
 };
 
-namespace detail {
-    struct NullOstream : std::ostream
-    {
-        NullOstream() : std::ios(nullptr), std::ostream(nullptr) {}
-    };
-}
-
-template<class T0, class T1, class T2, class T3, class T4>
-Result quickCheck(const Property<T0, T1, T2, T3, T4> &prop,
-        std::size_t maxSuccess = 100, std::size_t maxDiscarded = 0,
-        std::size_t maxSize = 0)
-{
-    detail::NullOstream out;
-    return quickCheckOutput(prop, out, maxSuccess, maxDiscarded, maxSize);
-}
-
 namespace detail {
     inline std::multimap<std::size_t, std::string> convertLabels(
             const std::map<std::string, std::size_t> &labelsCollected)
@@ -114,25 +147,201 @@ namespace detail {
         }
     }
 
-    template<class T0, class T1, class T2, class T3, class T4>
-    std::pair<std::size_t, typename Property<T0, T1, T2, T3, T4>::Input>
+    inline void outputMeasurementTable(std::ostream &out,
+            const MeasurementTable &table)
+    {
+        const char *sep = " ";
+        for (const auto &m : table) {
+            out << sep << m.first << ' ' << m.second.mean() << " ("
+                << m.second.min << ".." << m.second.max << ", "
+                << m.second.percentile(0.5) << '/'
+                << m.second.percentile(0.9) << '/'
+                << m.second.percentile(0.99) << ')';
+            sep = ", ";
+        }
+        out << std::endl;
+    }
+
+    inline void outputMeasurements(std::ostream &out,
+            const std::map<std::string, MeasurementTable> &byLabel,
+            const std::map<std::size_t, MeasurementTable> &bySize)
+    {
+        if (byLabel.empty())
+            return;
+
+        out << "Measurements per check "
+            << "(mean, min..max, median/p90/p99):" << std::endl;
+        for (const auto &label : byLabel) {
+            out << "  " << (label.first.empty() ? "(no label)" : label.first)
+                << ':';
+            outputMeasurementTable(out, label.second);
+        }
+        if (bySize.size() > 1) {
+            for (const auto &bucket : bySize) {
+                out << "  size " << bucket.first;
+                if (bucket.first > 1)
+                    out << ".." << 2 * bucket.first - 1;
+                out << ':';
+                outputMeasurementTable(out, bucket.second);
+            }
+        }
+    }
+
+}
+
+/*
+ * A reporter receives the events of a test run and decides what to make of
+ * them. The runner is a template on the reporter, so a reporter only pays
+ * for the events it handles: NullReporter does nothing, and since its
+ * functions are empty and inline, a silent run does not format messages or
+ * pretty-print inputs at all. A reporter provides:
+ *
+ *      void start(const PropertyBase &prop);
+ *      void exceptionCaught();
+ *      void shrinkTimedOut();
+ *      template<class Input>
+ *      void failed(const PropertyBase &prop, std::size_t numTests,
+ *                  std::size_t numShrinks, const Input &in,
+ *                  const TestCaseId &testCase);
+ *      void gaveUp(std::size_t numTests);
+ *      void passed(const PropertyBase &prop, std::size_t numTrivial,
+ *                  const Result &result);
+ *
+ * "failed" is called both for unexpected failures and for properties that
+ * failed as expected (prop.expect() is false); "passed" is called for all
+ * runs that passed maxSuccess tests, including those that were expected to
+ * fail.
+ */
+
+/// Discards all events.
+struct NullReporter
+{
+    void start(const PropertyBase &) {}
+    void exceptionCaught() {}
+    void shrinkTimedOut() {}
+
+    template<class Input>
+    void failed(const PropertyBase &, std::size_t, std::size_t,
+                const Input &, const TestCaseId &) {}
+
+    void gaveUp(std::size_t) {}
+    void passed(const PropertyBase &, std::size_t, const Result &) {}
+};
+
+/// Writes the human readable report of quickCheckOutput to a stream.
+class StreamReporter
+{
+    public:
+        explicit StreamReporter(std::ostream &out) : m_out(out) {}
+
+        void start(const PropertyBase &prop)
+        {
+            m_out << "* Checking property \"" << prop.name() << "\" ..."
+                  << std::endl;
+        }
+
+        void exceptionCaught()
+        {
+            m_out << "Caught exception checking property...\n";
+        }
+
+        void shrinkTimedOut()
+        {
+            m_out << "Shrinking timed out...\n";
+        }
+
+        template<class Input>
+        void failed(const PropertyBase &prop, std::size_t numTests,
+                    std::size_t numShrinks, const Input &in,
+                    const TestCaseId &testCase)
+        {
+            if (prop.expect()) {
+                m_out << "*** Failed! ";
+            } else {
+                m_out << "+++ OK, failed as expected. ";
+            }
+
+            m_out << "Falsifiable after " << numTests
+                  << (numTests == 1 ? " test" : " tests");
+            if (numShrinks > 0) {
+                m_out << " and " << numShrinks
+                      << (numShrinks == 1 ? " shrink" : " shrinks");
+            }
+            m_out << " for input:\n";
+            printInput(m_out, in);
+            dumpInput(m_out, in);
+            if (!testCase.reproduction.empty()) {
+                m_out << "(To reproduce the test, use "
+                      << testCase.reproduction << ")\n";
+                return;
+            }
+            m_out << "(To reproduce the test, use "
+                  << CPPQUICKCHECK_SEED_ENV << '=' << testCase.seed
+                  << ", or to check only the failing case, use "
+                  << CPPQUICKCHECK_REPLAY_ENV << '=' << testCase << ")\n";
+        }
+
+        void gaveUp(std::size_t numTests)
+        {
+            m_out << "*** Gave up! Passed only " << numTests << " tests."
+                  << std::endl;
+        }
+
+        void passed(const PropertyBase &prop, std::size_t numTrivial,
+                    const Result &result)
+        {
+            if (prop.expect()) {
+                m_out << "+++ OK, passed " << result.numTests << " tests";
+            } else {
+                m_out << "*** Failed! Expected failure but passed "
+                      << result.numTests << " tests";
+            }
+            if (numTrivial != 0) {
+                m_out << " (" << (100 * numTrivial / result.numTests)
+                      << "% trivial)";
+            }
+            if (result.numDuplicates != 0) {
+                m_out << " (" << result.numDuplicates << " duplicate"
+                      << (result.numDuplicates == 1 ? "" : "s")
+                      << " skipped)";
+            }
+            m_out << '.' << std::endl;
+            detail::outputLabels(m_out, result.numTests, result.labels);
+            detail::outputMeasurements(m_out, result.measurements,
+                                       result.measurementsBySize);
+        }
+
+    private:
+        std::ostream &m_out;
+};
+
+namespace detail {
+    template<class Input>
+    struct ShrinkResult
+    {
+        std::size_t numShrinks; // accepted shrinks
+        std::size_t numEvaluations; // checks of shrink candidates
+        Input input;
+        Choices choices; // SHRINK_CHOICES only
+    };
+
+    template<class T0, class T1, class T2, class T3, class T4, class Reporter>
+    ShrinkResult<typename Property<T0, T1, T2, T3, T4>::Input>
     doShrink(const Property<T0, T1, T2, T3, T4> &prop,
-             const typename Property<T0, T1, T2, T3, T4>::Input &in,
-             std::chrono::duration<double> timeout)
+             ShrinkTree<typename Property<T0, T1, T2, T3, T4>::Input> shrunk,
+             std::chrono::duration<double> timeout, Reporter &reporter)
     {
         typedef typename Property<T0, T1, T2, T3, T4>::Input Input;
 
-        std::size_t numShrinks = 0;
-        Input shrunk = in;
+        std::size_t numShrinks = 0, numEvaluations = 0;
         const auto start = std::chrono::steady_clock::now();
 
         try {
 continueShrinking:
-            std::vector<Input> shrinks =
-                prop.shrinkInput(shrunk);
-            for (Input input : shrinks) {
-                if (!prop.checkInput(input)) {
-                    shrunk = std::move(input);
+            for (ShrinkTree<Input> &candidate : shrunk.children()) {
+                ++numEvaluations;
+                if (!prop.checkInput(candidate.value())) {
+                    shrunk = std::move(candidate);
                     numShrinks++;
                     goto continueShrinking;
                 }
@@ -141,13 +350,36 @@ continueShrinking:
                 const std::chrono::duration<double> elapsed =
                     std::chrono::steady_clock::now() - start;
                 if (elapsed >= timeout) {
-                    std::cout << "Shrinking timed out...\n";
+                    reporter.shrinkTimedOut();
                     break;
                 }
             }
         } catch (...) {
         }
-        return std::make_pair(numShrinks, shrunk);
+        ShrinkResult<Input> ret = { numShrinks, numEvaluations,
+                                    std::move(shrunk.value()), Choices() };
+        return ret;
+    }
+
+    template<class T0, class T1, class T2, class T3, class T4, class Reporter>
+    ShrinkResult<typename Property<T0, T1, T2, T3, T4>::Input>
+    doShrinkChoices(const Property<T0, T1, T2, T3, T4> &prop,
+            const Choices &choices, std::size_t size,
+            const typename Property<T0, T1, T2, T3, T4>::Input &in,
+            std::chrono::duration<double> timeout, Reporter &reporter)
+    {
+        typedef typename Property<T0, T1, T2, T3, T4>::Input Input;
+
+        ChoiceShrinker<T0, T1, T2, T3, T4, Reporter> shrinker(prop, size,
+            choices, in, timeout, reporter);
+        try {
+            shrinker.run();
+        } catch (...) {
+        }
+        ShrinkResult<Input> ret = { shrinker.numShrinks(),
+            shrinker.numEvaluations(), std::move(shrinker.input()),
+            shrinker.choices() };
+        return ret;
     }
 }
 
@@ -179,140 +411,325 @@ namespace detail {
     }
 }
 
+namespace detail {
+    // Returns true and the test case if CPPQUICKCHECK_REPLAY is set.
+    inline bool replayFromEnv(TestCaseId &testCase)
+    {
+        const char* replay = std::getenv(CPPQUICKCHECK_REPLAY_ENV);
+        if (replay == nullptr || *replay == '\0')
+            return false;
+
+        std::istringstream in(replay);
+        unsigned long long seed = 0;
+        char sep1 = 0, sep2 = 0;
+        if (!(in >> seed >> sep1 >> testCase.index >> sep2 >> testCase.size)
+                || sep1 != ':' || sep2 != ':' || !in.eof()
+                || seed >= USE_DEFAULT_SEED) {
+            std::ostringstream err;
+            err << "Failed to parse test case in environment variable "
+                << CPPQUICKCHECK_REPLAY_ENV
+                << ": Got <" << replay
+                << ">, but expected \"seed:index:size\" as printed for "
+                   "a failing test. To run all tests instead, "
+                   "unset the environment variable.";
+            throw std::invalid_argument{err.str()};
+        }
+        testCase.seed = static_cast<SeedType>(seed);
+        return true;
+    }
+
+    // Fuzzer data is read as little endian 32-bit words, the last one
+    // padded with zeros: the first gives the size, the others are the
+    // choices the generator draws.
+    inline void decodeFuzzInput(const std::uint8_t *data, std::size_t n,
+            std::size_t maxSize, std::size_t &size, Choices &choices)
+    {
+        choices.assign((n + 3) / 4, 0);
+        for (std::size_t i = 0; i < n; ++i)
+            choices[i / 4] |= std::uint32_t(data[i]) << (8 * (i % 4));
+        size = choices.empty() ? 0 : choices.front() % (maxSize + 1);
+        if (!choices.empty())
+            choices.erase(choices.begin());
+    }
+
+    // Returns true and the decoded input if CPPQUICKCHECK_FUZZ_INPUT is set.
+    inline bool fuzzInputFromEnv(std::size_t maxSize, TestCaseId &testCase,
+                                 Choices &choices)
+    {
+        const char* path = std::getenv(CPPQUICKCHECK_FUZZ_INPUT_ENV);
+        if (path == nullptr || *path == '\0')
+            return false;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::invalid_argument(std::string("Failed to read ") +
+                path + " given in " + CPPQUICKCHECK_FUZZ_INPUT_ENV);
+        }
+        const std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                                      std::istreambuf_iterator<char>());
+        testCase = TestCaseId();
+        testCase.reproduction =
+            std::string(CPPQUICKCHECK_FUZZ_INPUT_ENV) + '=' + path;
+        decodeFuzzInput(reinterpret_cast<const std::uint8_t *>(bytes.data()),
+                        bytes.size(), maxSize, testCase.size, choices);
+        return true;
+    }
+
+    // The generator of a test case depends only on its id, so any test
+    // case can be regenerated on its own. It knows its position in the
+    // run (see RngEngine::setRunPosition).
+    inline RngEngine testCaseRng(const TestCaseId &testCase)
+    {
+        const std::uint64_t index = testCase.index, size = testCase.size;
+        std::seed_seq seq{std::uint32_t(testCase.seed),
+            std::uint32_t(index), std::uint32_t(index >> 32),
+            std::uint32_t(size), std::uint32_t(size >> 32)};
+        RngEngine rng(seq);
+        rng.setRunPosition(testCase.seed, testCase.index);
+        return rng;
+    }
+}
+
 constexpr auto DEFAULT_SHRINK_TIMEOUT = std::chrono::seconds(30);
 constexpr auto DISABLE_SHRINK_TIMEOUT = std::chrono::seconds::max();
 
-template<class T0, class T1, class T2, class T3, class T4>
-Result quickCheckOutput(const Property<T0, T1, T2, T3, T4> &prop,
-        std::ostream &out = std::cout,
-        std::size_t maxSuccess = 100,
-        std::size_t maxDiscarded = 0, std::size_t maxSize = 0,
-        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
-        SeedType seed = USE_DEFAULT_SEED)
-{
-    typedef typename Property<T0, T1, T2, T3, T4>::Input Input;
+namespace detail {
+    // Everything the runner accumulates while checking a property. As
+    // every test case has its own generator (see testCaseRng), this is
+    // all that is needed to continue a run (see Checkpoint.h).
+    struct RunState
+    {
+        RunState() :
+            seed(0), maxSuccess(0), maxDiscarded(0), maxSize(0),
+            numSuccess(0), numDiscarded(0), numDuplicates(0), numTrivial(0)
+        {
+        }
 
-    out << "* Checking property \"" << prop.name() << "\" ..." << std::endl;
+        SeedType seed;
+        std::size_t maxSuccess;
+        std::size_t maxDiscarded;
+        std::size_t maxSize;
+
+        std::size_t numSuccess;
+        std::size_t numDiscarded;
+        std::size_t numDuplicates;
+        std::size_t numTrivial;
+        std::map<std::string, std::size_t> labelsCollected;
+        std::map<std::string, MeasurementTable> measurementsCollected;
+        std::map<std::size_t, MeasurementTable> measurementsBySize;
+    };
 
-    if (maxDiscarded == 0)
-        maxDiscarded = maxSuccess * 5;
-    if (maxSize == 0)
-        maxSize = 100;
+    inline RunState initialRunState(std::size_t maxSuccess,
+            std::size_t maxDiscarded, std::size_t maxSize, SeedType seed)
+    {
+        RunState state;
+        state.maxSuccess = maxSuccess;
+        state.maxDiscarded = maxDiscarded == 0 ? maxSuccess * 5 : maxDiscarded;
+        state.maxSize = maxSize == 0 ? 100 : maxSize;
+        state.seed = resolveSeed(seed);
+        return state;
+    }
 
-    std::map<std::string, std::size_t> labelsCollected;
-    std::size_t numSuccess = 0, numDiscarded = 0, numTrivial = 0;
+    inline Result resultOf(const RunState &state, ResultType type,
+                           std::size_t numTests)
+    {
+        Result ret;
+        ret.result = type;
+        ret.numTests = numTests;
+        ret.numDuplicates = state.numDuplicates;
+        ret.labels = convertLabels(state.labelsCollected);
+        ret.seed = state.seed;
+        ret.measurements = state.measurementsCollected;
+        ret.measurementsBySize = state.measurementsBySize;
+        return ret;
+    }
 
-    seed = detail::resolveSeed(seed);
-    RngEngine rng{seed};
-    while (numSuccess < maxSuccess) {
-        try {
-            std::size_t size = (numSuccess * maxSize + numDiscarded) / maxSuccess;
-            Input in = prop.generateInput(rng, size);
-            bool success = false;
-            try {
-                success = prop.checkInput(in);
-            } catch (...) {
-                out << "Caught exception checking property...\n";
-            }
+    // Called after every test case that passed, was discarded or was
+    // skipped as a duplicate.
+    struct NoProgressHook
+    {
+        void operator()(const RunState &) {}
+    };
+
+    // Runs the test cases from the given state on. If replay is not null,
+    // only that test case is checked; if replayChoices is not null too, it
+    // is generated from those choices.
+    //
+    // If the property skips duplicates, they count towards the size like
+    // discarded test cases, and have a budget of maxDiscarded of their
+    // own. Once it is used up, the inputs are considered exhausted, and
+    // the run passes with the distinct inputs checked so far. The filter
+    // is not part of the state, so a resumed run starts with an empty one.
+    template<class T0, class T1, class T2, class T3, class T4,
+             class Reporter, class ProgressHook>
+    Result runTests(const Property<T0, T1, T2, T3, T4> &prop,
+            Reporter &reporter, RunState &state,
+            std::chrono::duration<double> shrinkTimeout,
+            const TestCaseId *replay, ProgressHook &onProgress,
+            const Choices *replayChoices = nullptr)
+    {
+        typedef typename Property<T0, T1, T2, T3, T4>::Input Input;
 
-            if (prop.trivialInput(in))
-                ++numTrivial;
-            ++labelsCollected[prop.classifyInput(in)];
+        const bool skipDuplicates = replay == nullptr &&
+                                    prop.skipDuplicates();
+        if (skipDuplicates && !BinaryDump<Input>::supported)
+            throw std::logic_error("Property \"" + prop.name() +
+                "\" skips duplicates, but its input has no BinaryDump");
+        BloomFilter checked(skipDuplicates ? state.maxSuccess : 0);
 
-            if (success) {
-                ++numSuccess;
-            } else {
-                if (prop.expect()) {
-                    out << "*** Failed! ";
+        while (state.numSuccess < state.maxSuccess) {
+            try {
+                TestCaseId testCase;
+                if (replay != nullptr) {
+                    testCase = *replay;
                 } else {
-                    out << "+++ OK, failed as expected. ";
+                    testCase.seed = state.seed;
+                    testCase.index = state.numSuccess + state.numDiscarded +
+                                     state.numDuplicates;
+                    testCase.size = (state.numSuccess * state.maxSize +
+                                     state.numDiscarded +
+                                     state.numDuplicates) / state.maxSuccess;
                 }
-
-                out << "Falsifiable after " << numSuccess + 1
-                    << (numSuccess == 0 ? " test" : " tests");
-
-                std::size_t numShrinks = 0;
+                const std::size_t size = testCase.size;
+                RngEngine rng = testCaseRng(testCase);
+                const bool shrinkChoices =
+                    prop.shrinkStrategy() == SHRINK_CHOICES;
+                Choices choices;
+                if (replayChoices != nullptr)
+                    rng.replay(replayChoices, REPLAY_ZEROS);
+                if (shrinkChoices)
+                    rng.record(&choices);
+                const ShrinkTree<Input> tree =
+                    prop.generateInputTree(rng, size);
+                const Input &in = tree.value();
+                if (skipDuplicates && checked.insert(hashInput(in))) {
+                    if (++state.numDuplicates >= state.maxDiscarded)
+                        break;
+                    onProgress(static_cast<const RunState &>(state));
+                    continue;
+                }
+                bool success = false;
+                CheckMeasurements measurements;
                 try {
-                    std::pair<std::size_t, Input> shrinkRes =
-                        detail::doShrink(prop, in, shrinkTimeout);
-                    numShrinks = shrinkRes.first;
-                    if (numShrinks > 0) {
-                        out << " and " << numShrinks
-                            << (numShrinks == 1 ? " shrink" : " shrinks");
-                    }
-                    out << " for input:\n";
-                    printInput(out, shrinkRes.second);
+                    MeasurementScope scope(measurements);
+                    success = prop.checkInput(in);
                 } catch (...) {
-                    out << " for input:\n";
-                    printInput(out, in);
+                    reporter.exceptionCaught();
                 }
-                out << "(To reproduce the test, use "
-                    << CPPQUICKCHECK_SEED_ENV << '=' << seed << ")\n";
-
-                if (prop.expect()) {
-                    Result ret;
-                    ret.result = QC_FAILURE;
-                    ret.numTests = numSuccess + 1;
-                    ret.labels = detail::convertLabels(labelsCollected);
-                    ret.seed = seed;
-                    ret.numShrinks = numShrinks;
-                    ret.usedSize = size;
-                    return ret;
+
+                if (prop.trivialInput(in))
+                    ++state.numTrivial;
+                const std::string label = prop.classifyInput(in);
+                ++state.labelsCollected[label];
+                if (!measurements.empty()) {
+                    addMeasurements(state.measurementsCollected[label],
+                                    measurements);
+                    addMeasurements(
+                        state.measurementsBySize[sizeBucket(size)],
+                        measurements);
+                }
+
+                if (success) {
+                    ++state.numSuccess;
+                    onProgress(static_cast<const RunState &>(state));
                 } else {
-                    Result ret;
-                    ret.result = QC_SUCCESS;
-                    ret.numTests = numSuccess + 1;
-                    ret.labels = detail::convertLabels(labelsCollected);
-                    ret.seed = seed;
-                    return ret;
+                    std::size_t numShrinks = 0, numEvaluations = 0;
+                    try {
+                        const ShrinkResult<Input> shrinkRes = shrinkChoices ?
+                            doShrinkChoices(prop, choices, size, in,
+                                            shrinkTimeout, reporter) :
+                            doShrink(prop, tree, shrinkTimeout, reporter);
+                        numShrinks = shrinkRes.numShrinks;
+                        numEvaluations = shrinkRes.numEvaluations;
+                        choices = shrinkRes.choices;
+                        reporter.failed(prop, state.numSuccess + 1,
+                                        numShrinks, shrinkRes.input,
+                                        testCase);
+                    } catch (...) {
+                        reporter.failed(prop, state.numSuccess + 1, 0, in,
+                                        testCase);
+                    }
+
+                    if (prop.expect()) {
+                        Result ret = resultOf(state, QC_FAILURE,
+                                              state.numSuccess + 1);
+                        ret.numShrinks = numShrinks;
+                        ret.numShrinkEvaluations = numEvaluations;
+                        ret.usedSize = size;
+                        ret.failedTestCase = testCase;
+                        ret.failedChoices = std::move(choices);
+                        return ret;
+                    } else {
+                        return resultOf(state, QC_SUCCESS,
+                                        state.numSuccess + 1);
+                    }
                 }
-            }
-        } catch (...) {
-            if (++numDiscarded >= maxDiscarded) {
-                out << "*** Gave up! Passed only " << numSuccess << " tests."
-                    << std::endl;
-
-                Result ret;
-                ret.result = QC_GAVE_UP;
-                ret.numTests = numSuccess;
-                ret.labels = detail::convertLabels(labelsCollected);
-                ret.seed = seed;
-                return ret;
+            } catch (...) {
+                if (++state.numDiscarded >= state.maxDiscarded) {
+                    reporter.gaveUp(state.numSuccess);
+                    return resultOf(state, QC_GAVE_UP, state.numSuccess);
+                }
+                onProgress(static_cast<const RunState &>(state));
             }
         }
-    }
 
-    std::multimap<std::size_t, std::string> labels =
-        detail::convertLabels(labelsCollected);
+        const Result ret = resultOf(state,
+            prop.expect() ? QC_SUCCESS : QC_NO_EXPECTED_FAILURE,
+            state.numSuccess);
+        reporter.passed(prop, state.numTrivial, ret);
+        return ret;
+    }
+}
 
-    if (prop.expect()) {
-        out << "+++ OK, passed " << numSuccess << " tests";
-        if (numTrivial != 0)
-            out << " (" << (100 * numTrivial / numSuccess) << "% trivial)";
-        out << '.' << std::endl;
-        detail::outputLabels(out, numSuccess, labels);
+/// Runs the property and reports the events of the run to the reporter
+/// (see StreamReporter and NullReporter). If CPPQUICKCHECK_REPLAY or
+/// CPPQUICKCHECK_FUZZ_INPUT is set, only the given test case is checked
+/// (and shrunk if it fails).
+template<class T0, class T1, class T2, class T3, class T4, class Reporter>
+Result quickCheckReport(const Property<T0, T1, T2, T3, T4> &prop,
+        Reporter &reporter,
+        std::size_t maxSuccess = 100,
+        std::size_t maxDiscarded = 0, std::size_t maxSize = 0,
+        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
+        SeedType seed = USE_DEFAULT_SEED)
+{
+    reporter.start(prop);
+
+    TestCaseId replay;
+    Choices fuzzChoices;
+    const bool fuzzing = detail::fuzzInputFromEnv(
+        maxSize == 0 ? 100 : maxSize, replay, fuzzChoices);
+    const bool replaying = fuzzing || detail::replayFromEnv(replay);
+    detail::RunState state = replaying ?
+        detail::initialRunState(1, 1, replay.size, replay.seed) :
+        detail::initialRunState(maxSuccess, maxDiscarded, maxSize, seed);
+    detail::NoProgressHook noProgressHook;
+    return detail::runTests(prop, reporter, state, shrinkTimeout,
+                            replaying ? &replay : nullptr, noProgressHook,
+                            fuzzing ? &fuzzChoices : nullptr);
+}
 
-        Result ret;
-        ret.result = QC_SUCCESS;
-        ret.numTests = numSuccess;
-        ret.labels = labels;
-        ret.seed = seed;
-        return ret;
-    } else {
-        out << "*** Failed! Expected failure but passed " << numSuccess
-            << " tests";
-        if (numTrivial != 0)
-            out << " (" << (100 * numTrivial / numSuccess) << "% trivial)";
-        out << '.' << std::endl;
-        detail::outputLabels(out, numSuccess, labels);
+template<class T0, class T1, class T2, class T3, class T4>
+Result quickCheckOutput(const Property<T0, T1, T2, T3, T4> &prop,
+        std::ostream &out = std::cout,
+        std::size_t maxSuccess = 100,
+        std::size_t maxDiscarded = 0, std::size_t maxSize = 0,
+        std::chrono::duration<double> shrinkTimeout = DEFAULT_SHRINK_TIMEOUT,
+        SeedType seed = USE_DEFAULT_SEED)
+{
+    StreamReporter reporter(out);
+    return quickCheckReport(prop, reporter, maxSuccess, maxDiscarded,
+                            maxSize, shrinkTimeout, seed);
+}
 
-        Result ret;
-        ret.result = QC_NO_EXPECTED_FAILURE;
-        ret.numTests = numSuccess;
-        ret.labels = labels;
-        ret.seed = seed;
-        return ret;
-    }
+template<class T0, class T1, class T2, class T3, class T4>
+Result quickCheck(const Property<T0, T1, T2, T3, T4> &prop,
+        std::size_t maxSuccess = 100, std::size_t maxDiscarded = 0,
+        std::size_t maxSize = 0)
+{
+    NullReporter reporter;
+    return quickCheckReport(prop, reporter, maxSuccess, maxDiscarded,
+                            maxSize);
 }
 
 }
@@ -0,0 +1,204 @@
+#include "cppqc/AllocationCounter.h"
+#include "cppqc/Measurement.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local cppqc::AllocationCounts counts;
+thread_local std::ptrdiff_t peakLiveBytes = 0;
+thread_local int uncountedDepth = 0;
+
+std::ptrdiff_t liveBytes()
+{
+    return std::ptrdiff_t(counts.bytesAllocated - counts.bytesFreed);
+}
+
+// Every block is prefixed with its size, so that operator delete knows
+// how many bytes are released, and whether it was counted at all. The
+// prefix keeps the alignment guaranteed by malloc.
+union Header
+{
+    struct
+    {
+        std::size_t size;
+        bool counted;
+    } block;
+    std::max_align_t align;
+};
+
+void *countedAlloc(std::size_t size)
+{
+    Header *h = static_cast<Header *>(std::malloc(sizeof(Header) + size));
+    if (h == nullptr)
+        return nullptr;
+    h->block.size = size;
+    h->block.counted = uncountedDepth == 0;
+    if (h->block.counted) {
+        ++counts.allocations;
+        counts.bytesAllocated += size;
+        if (liveBytes() > peakLiveBytes)
+            peakLiveBytes = liveBytes();
+    }
+    return h + 1;
+}
+
+void countedFree(void *p)
+{
+    if (p == nullptr)
+        return;
+    Header *h = static_cast<Header *>(p) - 1;
+    if (h->block.counted) {
+        ++counts.deallocations;
+        counts.bytesFreed += h->block.size;
+    }
+    std::free(h);
+}
+
+void *countedNew(std::size_t size)
+{
+    for (;;) {
+        if (void *p = countedAlloc(size))
+            return p;
+        std::new_handler handler = std::get_new_handler();
+        if (handler == nullptr)
+            throw std::bad_alloc();
+        handler();
+    }
+}
+
+// Reports the allocations and heap usage of each check to the runner.
+class AllocationProbe : public cppqc::CheckProbe
+{
+    public:
+        void start() override
+        {
+            m_start = counts;
+            m_outerPeak = cppqc::exchangeThreadPeakLiveBytes(liveBytes());
+        }
+
+        void stop() override
+        {
+            const cppqc::AllocationCounts end = counts;
+            const std::ptrdiff_t peak = peakLiveBytes;
+            cppqc::exchangeThreadPeakLiveBytes(std::max(m_outerPeak, peak));
+
+            const std::ptrdiff_t startLive =
+                std::ptrdiff_t(m_start.bytesAllocated - m_start.bytesFreed);
+            cppqc::recordMeasurement("allocations",
+                double(end.allocations - m_start.allocations));
+            cppqc::recordMeasurement("allocated bytes",
+                double(end.bytesAllocated - m_start.bytesAllocated));
+            cppqc::recordMeasurement("peak heap bytes",
+                double(peak - startLive));
+            cppqc::recordMeasurement("retained heap bytes",
+                double(std::ptrdiff_t(end.bytesAllocated - end.bytesFreed) -
+                       startLive));
+        }
+
+    private:
+        cppqc::AllocationCounts m_start;
+        std::ptrdiff_t m_outerPeak;
+};
+
+AllocationProbe probe;
+cppqc::ProbeRegistration registration(probe);
+
+}
+
+namespace cppqc {
+
+AllocationCounts threadAllocationCounts()
+{
+    return counts;
+}
+
+std::ptrdiff_t threadLiveBytes()
+{
+    return liveBytes();
+}
+
+std::ptrdiff_t threadPeakLiveBytes()
+{
+    return peakLiveBytes;
+}
+
+std::ptrdiff_t exchangeThreadPeakLiveBytes(std::ptrdiff_t peak)
+{
+    const std::ptrdiff_t previous = peakLiveBytes;
+    peakLiveBytes = peak;
+    return previous;
+}
+
+UncountedAllocations::UncountedAllocations()
+{
+    ++uncountedDepth;
+}
+
+UncountedAllocations::~UncountedAllocations()
+{
+    --uncountedDepth;
+}
+
+}
+
+void *operator new(std::size_t size)
+{
+    return countedNew(size);
+}
+
+void *operator new[](std::size_t size)
+{
+    return countedNew(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return countedNew(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    try {
+        return countedNew(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void *p) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    countedFree(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    countedFree(p);
+}
@@ -4,47 +4,82 @@ namespace cppqc {
 
 const Arbitrary<bool>::unGenType ArbitraryImpl<bool>::unGen = arbitraryBool;
 const Arbitrary<bool>::shrinkType ArbitraryImpl<bool>::shrink = shrinkBool;
+const Arbitrary<bool>::enumSizeType ArbitraryImpl<bool>::enumSize =
+    enumSizeBool;
+const Arbitrary<bool>::enumAtType ArbitraryImpl<bool>::enumAt = enumBool;
 
 const Arbitrary<signed char>::unGenType ArbitraryImpl<signed char>::unGen =
     arbitrarySizedBoundedIntegral<signed char>;
 const Arbitrary<signed char>::shrinkType ArbitraryImpl<signed char>::shrink =
     shrinkIntegral<signed char>;
+const Arbitrary<signed char>::enumSizeType
+    ArbitraryImpl<signed char>::enumSize = enumSizeIntegral<signed char>;
+const Arbitrary<signed char>::enumAtType ArbitraryImpl<signed char>::enumAt =
+    enumIntegral<signed char>;
 
 const Arbitrary<unsigned char>::unGenType ArbitraryImpl<unsigned char>::unGen =
     arbitrarySizedBoundedIntegral<unsigned char>;
 const Arbitrary<unsigned char>::shrinkType
     ArbitraryImpl<unsigned char>::shrink = shrinkIntegral<unsigned char>;
+const Arbitrary<unsigned char>::enumSizeType
+    ArbitraryImpl<unsigned char>::enumSize = enumSizeIntegral<unsigned char>;
+const Arbitrary<unsigned char>::enumAtType
+    ArbitraryImpl<unsigned char>::enumAt = enumIntegral<unsigned char>;
 
 const Arbitrary<signed short>::unGenType ArbitraryImpl<signed short>::unGen =
     arbitrarySizedBoundedIntegral<signed short>;
 const Arbitrary<signed short>::shrinkType ArbitraryImpl<signed short>::shrink =
     shrinkIntegral<signed short>;
+const Arbitrary<signed short>::enumSizeType
+    ArbitraryImpl<signed short>::enumSize = enumSizeIntegral<signed short>;
+const Arbitrary<signed short>::enumAtType ArbitraryImpl<signed short>::enumAt =
+    enumIntegral<signed short>;
 
 const Arbitrary<unsigned short>::unGenType
     ArbitraryImpl<unsigned short>::unGen =
     arbitrarySizedBoundedIntegral<unsigned short>;
 const Arbitrary<unsigned short>::shrinkType
     ArbitraryImpl<unsigned short>::shrink = shrinkIntegral<unsigned short>;
+const Arbitrary<unsigned short>::enumSizeType
+    ArbitraryImpl<unsigned short>::enumSize = enumSizeIntegral<unsigned short>;
+const Arbitrary<unsigned short>::enumAtType
+    ArbitraryImpl<unsigned short>::enumAt = enumIntegral<unsigned short>;
 
 const Arbitrary<signed int>::unGenType ArbitraryImpl<signed int>::unGen =
     arbitrarySizedBoundedIntegral<signed int>;
 const Arbitrary<signed int>::shrinkType ArbitraryImpl<signed int>::shrink =
     shrinkIntegral<signed int>;
+const Arbitrary<signed int>::enumSizeType
+    ArbitraryImpl<signed int>::enumSize = enumSizeIntegral<signed int>;
+const Arbitrary<signed int>::enumAtType ArbitraryImpl<signed int>::enumAt =
+    enumIntegral<signed int>;
 
 const Arbitrary<unsigned int>::unGenType ArbitraryImpl<unsigned int>::unGen =
     arbitrarySizedBoundedIntegral<unsigned int>;
 const Arbitrary<unsigned int>::shrinkType ArbitraryImpl<unsigned int>::shrink =
     shrinkIntegral<unsigned int>;
+const Arbitrary<unsigned int>::enumSizeType
+    ArbitraryImpl<unsigned int>::enumSize = enumSizeIntegral<unsigned int>;
+const Arbitrary<unsigned int>::enumAtType ArbitraryImpl<unsigned int>::enumAt =
+    enumIntegral<unsigned int>;
 
 const Arbitrary<signed long>::unGenType ArbitraryImpl<signed long>::unGen =
     arbitrarySizedBoundedIntegral<signed long>;
 const Arbitrary<signed long>::shrinkType ArbitraryImpl<signed long>::shrink =
     shrinkIntegral<signed long>;
+const Arbitrary<signed long>::enumSizeType
+    ArbitraryImpl<signed long>::enumSize = enumSizeIntegral<signed long>;
+const Arbitrary<signed long>::enumAtType ArbitraryImpl<signed long>::enumAt =
+    enumIntegral<signed long>;
 
 const Arbitrary<unsigned long>::unGenType ArbitraryImpl<unsigned long>::unGen =
     arbitrarySizedBoundedIntegral<unsigned long>;
 const Arbitrary<unsigned long>::shrinkType ArbitraryImpl<unsigned long>::shrink =
     shrinkIntegral<unsigned long>;
+const Arbitrary<unsigned long>::enumSizeType
+    ArbitraryImpl<unsigned long>::enumSize = enumSizeIntegral<unsigned long>;
+const Arbitrary<unsigned long>::enumAtType
+    ArbitraryImpl<unsigned long>::enumAt = enumIntegral<unsigned long>;
 
 const Arbitrary<float>::unGenType ArbitraryImpl<float>::unGen =
     arbitrarySizedReal<float>;
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/AllocationCounter.h"
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace cppqc;
+
+namespace AllocationCounterTestsFixtures {
+
+// Buffers that are longer than three elements are copied to the heap.
+int sumWithSmallBufferOptimization(const std::vector<int> &v)
+{
+    if (v.size() <= 3) {
+        int sum = 0;
+        for (int x : v)
+            sum += x;
+        return sum;
+    }
+    std::vector<int> copy(v);
+    int sum = 0;
+    for (int x : copy)
+        sum += x;
+    return sum;
+}
+
+struct SumMustNotAllocate : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        AllocationCounter counter;
+        sumWithSmallBufferOptimization(v);
+        return counter.allocations() == 0;
+    }
+};
+
+struct CopyAllocatesOnce : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        AllocationCounter counter;
+        std::vector<int> copy(v);
+        return counter.allocations() <= 1;
+    }
+    std::string classify(const std::vector<int> &v) const override
+    {
+        return v.empty() ? "empty" : "non-empty";
+    }
+};
+
+} // end AllocationCounterTestsFixtures
+
+using namespace AllocationCounterTestsFixtures;
+
+TEST_CASE("allocation counter counts allocations and bytes of the thread",
+          "[allocations]")
+{
+    // read the counters before the assertions, which allocate themselves
+    AllocationCounter counter;
+    int *volatile p = new int(42); // volatile keeps the allocation
+    const AllocationCounts afterNew = { counter.allocations(),
+        counter.deallocations(), counter.bytesAllocated(),
+        counter.bytesFreed() };
+    delete p;
+    const AllocationCounts afterDelete = { counter.allocations(),
+        counter.deallocations(), counter.bytesAllocated(),
+        counter.bytesFreed() };
+
+    REQUIRE(afterNew.allocations == 1);
+    REQUIRE(afterNew.bytesAllocated == sizeof(int));
+    REQUIRE(afterNew.deallocations == 0);
+    REQUIRE(afterDelete.deallocations == 1);
+    REQUIRE(afterDelete.bytesFreed == sizeof(int));
+}
+
+TEST_CASE("allocating code fails a zero allocation property and shrinks",
+          "[allocations]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckOutput(SumMustNotAllocate(), out);
+
+    REQUIRE(result.result == QC_FAILURE);
+    // the smallest vector that leaves the small buffer has four elements
+    REQUIRE(out.str().find("0: [0, 0, 0, 0]") != std::string::npos);
+}
+
+TEST_CASE("runner reports allocations per label",
+          "[allocations]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckOutput(CopyAllocatesOnce(), out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.measurements.count("non-empty") == 1);
+    const MeasurementTable &nonEmpty = result.measurements.at("non-empty");
+    REQUIRE(nonEmpty.at("allocations").min >= 1);
+    REQUIRE(nonEmpty.at("allocated bytes").min >= sizeof(int));
+    REQUIRE(out.str().find("allocations") != std::string::npos);
+}
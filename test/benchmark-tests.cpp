@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Benchmark.h"
+#include "catch.hpp"
+
+#include <cstdio>
+#include <numeric>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace BenchmarkTestsFixtures {
+
+struct SumWork
+{
+    explicit SumWork(int repeat) : repeat(repeat) {}
+
+    void operator()(const std::vector<int> &v) const
+    {
+        for (int i = 0; i < repeat; ++i) {
+            volatile long long sum = std::accumulate(v.begin(), v.end(), 0LL);
+            (void) sum;
+        }
+    }
+
+    int repeat;
+};
+
+struct TemporaryFile
+{
+    TemporaryFile() : path("cppqc-benchmark-test.baseline")
+    {
+        std::remove(path.c_str());
+    }
+
+    ~TemporaryFile()
+    {
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+} // end BenchmarkTestsFixtures
+
+using namespace BenchmarkTestsFixtures;
+
+TEST_CASE("bootstrap interval of identical samples contains one",
+          "[benchmark]")
+{
+    const std::vector<double> samples = {100, 102, 98, 101, 99, 100, 103, 97};
+    const std::pair<double, double> interval =
+        detail::bootstrapRatioInterval(samples, samples);
+    REQUIRE(interval.first <= 1.0);
+    REQUIRE(interval.second >= 1.0);
+
+    const std::vector<double> doubled =
+        {200, 204, 196, 202, 198, 200, 206, 194};
+    const std::pair<double, double> slower =
+        detail::bootstrapRatioInterval(samples, doubled);
+    REQUIRE(slower.first > 1.5);
+}
+
+TEST_CASE("benchmark records a baseline and detects slowdowns and speedups",
+          "[benchmark]")
+{
+    TemporaryFile file;
+    std::ostringstream out;
+    const Generator<std::vector<int>> gen = listOf<int>();
+
+    const BenchmarkResult first =
+        benchmarkAgainstBaseline(file.path, gen, SumWork(10), out);
+    REQUIRE(first.status == BENCH_BASELINE_WRITTEN);
+    REQUIRE(first.samples.size() == 20);
+
+    const BenchmarkResult slower =
+        benchmarkAgainstBaseline(file.path, gen, SumWork(200), out);
+    REQUIRE(slower.status == BENCH_SLOWER);
+    REQUIRE(slower.regressed());
+    REQUIRE(slower.baseline == first.samples);
+
+    const BenchmarkResult faster =
+        benchmarkAgainstBaseline(file.path, gen, SumWork(1), out);
+    REQUIRE(faster.status == BENCH_FASTER);
+    REQUIRE_FALSE(faster.regressed());
+}
+
+TEST_CASE("benchmark refuses a baseline of a different workload",
+          "[benchmark]")
+{
+    TemporaryFile file;
+    std::ostringstream out;
+    const Generator<std::vector<int>> gen = listOf<int>();
+
+    benchmarkAgainstBaseline(file.path, gen, SumWork(1), out, 10);
+    REQUIRE_THROWS_AS(
+        benchmarkAgainstBaseline(file.path, gen, SumWork(1), out, 20),
+        const std::runtime_error &);
+}
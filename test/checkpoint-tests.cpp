@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Checkpoint.h"
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace CheckpointTestsFixtures {
+
+struct RecordingProperty : Property<std::vector<int>>
+{
+    RecordingProperty() : sawCheckpoint(false) {}
+
+    bool check(const std::vector<int> &v) const override
+    {
+        inputs.push_back(v);
+        if (!checkpointPath.empty() &&
+                std::ifstream(checkpointPath.c_str()).good())
+            sawCheckpoint = true;
+        return true;
+    }
+
+    std::string classify(const std::vector<int> &v) const override
+    {
+        return v.empty() ? "empty" : "non-empty";
+    }
+
+    std::string name() const override
+    {
+        return "recording property";
+    }
+
+    mutable std::vector<std::vector<int>> inputs;
+    std::string checkpointPath;
+    mutable bool sawCheckpoint;
+};
+
+struct OtherProperty : Property<bool>
+{
+    bool check(const bool &) const override
+    {
+        return true;
+    }
+};
+
+struct TemporaryCheckpoint
+{
+    TemporaryCheckpoint() : path("cppqc-checkpoint-test.ckpt")
+    {
+        std::remove(path.c_str());
+    }
+
+    ~TemporaryCheckpoint()
+    {
+        std::remove(path.c_str());
+    }
+
+    bool exists() const
+    {
+        return std::ifstream(path.c_str()).good();
+    }
+
+    std::string path;
+};
+
+// Simulates a run that was interrupted after the given number of tests.
+detail::RunState interruptedRun(std::size_t numSuccess, SeedType seed)
+{
+    detail::RunState state = detail::initialRunState(100, 0, 0, seed);
+    state.numSuccess = numSuccess;
+    state.labelsCollected["empty"] = 1;
+    state.labelsCollected["non-empty"] = numSuccess - 1;
+    state.measurementsCollected["empty"]["elements"].add(0);
+    return state;
+}
+
+} // end CheckpointTestsFixtures
+
+using namespace CheckpointTestsFixtures;
+
+TEST_CASE("checkpoints round-trip the runner state", "[checkpoint]")
+{
+    TemporaryCheckpoint file;
+    detail::RunState state = interruptedRun(60, 7);
+    state.measurementsBySize[4]["a b"].add(1.5);
+    detail::writeCheckpoint(file.path, "my \"property\"\n", state);
+
+    detail::RunState restored;
+    REQUIRE(detail::readCheckpoint(file.path, "my \"property\"\n", restored));
+    REQUIRE(restored.seed == 7);
+    REQUIRE(restored.maxSuccess == 100);
+    REQUIRE(restored.numSuccess == 60);
+    REQUIRE(restored.labelsCollected == state.labelsCollected);
+    REQUIRE(restored.measurementsBySize.at(4).at("a b").sum == 1.5);
+
+    REQUIRE_THROWS_AS(
+        detail::readCheckpoint(file.path, "another property", restored),
+        const std::runtime_error &);
+}
+
+TEST_CASE("resumed runs continue without checking earlier test cases",
+          "[checkpoint]")
+{
+    RecordingProperty uninterrupted;
+    std::ostringstream out;
+    quickCheckOutput(uninterrupted, out, 100, 0, 0,
+                     DISABLE_SHRINK_TIMEOUT, 7);
+
+    TemporaryCheckpoint file;
+    detail::writeCheckpoint(file.path, "recording property",
+                            interruptedRun(60, 7));
+    RecordingProperty resumed;
+    const Result result = quickCheckResume(resumed, file.path, out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.numTests == 100);
+    REQUIRE(resumed.inputs.size() == 40);
+    REQUIRE(resumed.inputs == std::vector<std::vector<int>>(
+        uninterrupted.inputs.begin() + 60, uninterrupted.inputs.end()));
+    REQUIRE(result.measurements.at("empty").at("elements").count == 1);
+    REQUIRE(out.str().find("Resuming from") != std::string::npos);
+    REQUIRE_FALSE(file.exists());
+}
+
+TEST_CASE("checkpointed runs resume only matching checkpoints",
+          "[checkpoint]")
+{
+    TemporaryCheckpoint file;
+    std::ostringstream out;
+
+    RecordingProperty fresh;
+    fresh.checkpointPath = file.path;
+    const Result result = quickCheckCheckpointed(fresh, file.path, out, 100,
+        0, 0, DISABLE_SHRINK_TIMEOUT, 7, 10);
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(fresh.inputs.size() == 100);
+    REQUIRE(fresh.sawCheckpoint);
+    REQUIRE_FALSE(file.exists());
+
+    detail::writeCheckpoint(file.path, "recording property",
+                            interruptedRun(60, 7));
+    REQUIRE_THROWS_AS(quickCheckCheckpointed(fresh, file.path, out, 200),
+                      const std::runtime_error &);
+    REQUIRE_THROWS_AS(quickCheckResume(OtherProperty(), file.path, out),
+                      const std::runtime_error &);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "catch.hpp"
+
+using namespace cppqc;
+
+namespace ChoiceShrinkTestsFixtures {
+
+struct NoElementAbove50 : Property<std::vector<int>>
+{
+    // nothing to shrink along, as noShrink has no shrink tree
+    NoElementAbove50() : Property(noShrink(listOf<int>())) {}
+
+    ShrinkStrategy shrinkStrategy() const override
+    {
+        return SHRINK_CHOICES;
+    }
+
+    bool check(const std::vector<int> &v) const override
+    {
+        return std::all_of(v.begin(), v.end(), [](int x) { return x < 50; });
+    }
+};
+
+struct CapturingReporter : NullReporter
+{
+    template<class Input>
+    void failed(const PropertyBase &, std::size_t, std::size_t,
+                const Input &in, const TestCaseId &)
+    {
+        counterexample = std::get<0>(in);
+    }
+
+    std::vector<int> counterexample;
+};
+
+}
+
+using namespace ChoiceShrinkTestsFixtures;
+
+TEST_CASE("RngEngine draws the numbers of std::mt19937",
+          "[choice-shrink]")
+{
+    RngEngine rng(42);
+    std::mt19937 reference(42);
+    for (int i = 0; i < 100; ++i)
+        REQUIRE(rng() == reference());
+}
+
+TEST_CASE("recorded choices are replayed", "[choice-shrink]")
+{
+    Choices choices;
+    RngEngine recording(7);
+    recording.record(&choices);
+    const std::vector<int> v = listOf<int>().unGen(recording, 50);
+    REQUIRE(!choices.empty());
+
+    RngEngine replaying;
+    replaying.replay(&choices);
+    REQUIRE(listOf<int>().unGen(replaying, 50) == v);
+    REQUIRE(replaying.numReplayed() == choices.size());
+    REQUIRE_THROWS_AS(replaying(), const ChoicesExhausted &);
+}
+
+TEST_CASE("inputs without a shrink tree are shrunk on their choices",
+          "[choice-shrink]")
+{
+    NoElementAbove50 prop;
+    CapturingReporter reporter;
+    const Result result = quickCheckReport(prop, reporter, 100, 0, 0,
+                                           DISABLE_SHRINK_TIMEOUT, 42);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(result.numShrinks > 0);
+    REQUIRE(reporter.counterexample == std::vector<int>{50});
+
+    // the shrunk choices reproduce the counterexample
+    const std::vector<int> replayed = std::get<0>(
+        generateFromChoices(prop, result.failedChoices, result.usedSize));
+    REQUIRE(replayed == reporter.counterexample);
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc/Complexity.h"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace ComplexityTestsFixtures {
+
+std::vector<ComplexitySample> synthetic(double (*cost)(double))
+{
+    std::vector<ComplexitySample> samples;
+    for (int n = 0; n <= 100; n++)
+        samples.push_back(ComplexitySample(n, cost(n)));
+    return samples;
+}
+
+// Removes duplicates by comparing every pair of elements
+// and reports the number of comparisons as the cost.
+struct QuadraticDedupe : ComplexityProperty<std::vector<int>>
+{
+    explicit QuadraticDedupe(ComplexityClass bound) :
+        ComplexityProperty(bound) {}
+
+    double cost(const std::vector<int> &v) const override
+    {
+        std::size_t comparisons = 0;
+        std::vector<int> unique;
+        for (int x : v) {
+            bool found = false;
+            for (int y : unique) {
+                ++comparisons;
+                if (x == y) {
+                    found = true;
+                    break;
+                }
+            }
+            if (!found)
+                unique.push_back(x);
+        }
+        return double(comparisons);
+    }
+
+    double inputSize(std::size_t, const std::vector<int> &v) const override
+    {
+        return double(v.size());
+    }
+};
+
+// Sorting, measured by the number of comparisons.
+struct SortComparisons : ComplexityProperty<std::vector<int>>
+{
+    SortComparisons() : ComplexityProperty(O_N_LOG_N) {}
+
+    double cost(const std::vector<int> &v) const override
+    {
+        std::vector<int> copy(v);
+        std::size_t comparisons = 0;
+        std::stable_sort(copy.begin(), copy.end(),
+                         [&](int a, int b) { ++comparisons; return a < b; });
+        return double(comparisons);
+    }
+
+    double inputSize(std::size_t, const std::vector<int> &v) const override
+    {
+        return double(v.size());
+    }
+};
+
+} // end ComplexityTestsFixtures
+
+using namespace ComplexityTestsFixtures;
+
+TEST_CASE("fitting recognizes the complexity of synthetic costs",
+          "[complexity]")
+{
+    REQUIRE(fitComplexity(synthetic([](double) { return 7.0; })).complexity
+            == O_1);
+    REQUIRE(fitComplexity(synthetic([](double n) {
+        return 5 + 3 * std::log2(std::max(n, 1.0)); })).complexity == O_LOG_N);
+    REQUIRE(fitComplexity(synthetic([](double n) {
+        return 20 + 2 * n; })).complexity == O_N);
+    REQUIRE(fitComplexity(synthetic([](double n) {
+        return n * std::log2(std::max(n, 1.0)); })).complexity == O_N_LOG_N);
+    REQUIRE(fitComplexity(synthetic([](double n) {
+        return 1 + n * n / 2; })).complexity == O_N_SQUARED);
+}
+
+TEST_CASE("quadratic code fails a linear complexity bound",
+          "[complexity]")
+{
+    std::ostringstream out;
+    const ComplexityResult result =
+        quickCheckComplexity(QuadraticDedupe(O_N), out, 200, 200, 0);
+
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(result.fit.complexity > O_N);
+    REQUIRE(result.minFailingSize < result.maxFailingSize);
+}
+
+TEST_CASE("quadratic code passes a quadratic complexity bound",
+          "[complexity]")
+{
+    std::ostringstream out;
+    const ComplexityResult result =
+        quickCheckComplexity(QuadraticDedupe(O_N_SQUARED), out, 200, 200, 0);
+
+    REQUIRE(result.result == QC_SUCCESS);
+}
+
+TEST_CASE("sorting passes an n log n complexity bound",
+          "[complexity]")
+{
+    std::ostringstream out;
+    const ComplexityResult result =
+        quickCheckComplexity(SortComparisons(), out, 200, 200, 0);
+
+    REQUIRE(result.result == QC_SUCCESS);
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc/Differential.h"
+#include "catch.hpp"
+
+#include <numeric>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace DifferentialTestsFixtures {
+
+struct SumMatchesReference : DifferentialProperty<long, std::vector<int>>
+{
+    long reference(const std::vector<int> &v) const override
+    {
+        long sum = 0;
+        for (std::size_t i = 0; i < v.size(); ++i)
+            sum += v[i];
+        return sum;
+    }
+
+    long optimized(const std::vector<int> &v) const override
+    {
+        return std::accumulate(v.begin(), v.end(), 0L);
+    }
+
+    std::string classify(const std::vector<int> &v) const override
+    {
+        return v.size() < 10 ? "short" : "long";
+    }
+};
+
+// the "optimized" version forgets the last element
+struct BrokenSum : SumMatchesReference
+{
+    long optimized(const std::vector<int> &v) const override
+    {
+        return v.empty() ? 0 : std::accumulate(v.begin(), v.end() - 1, 0L);
+    }
+};
+
+struct MeanWithinTolerance : DifferentialProperty<double, std::vector<double>>
+{
+    MeanWithinTolerance() : DifferentialProperty(1e-9) {}
+
+    double reference(const std::vector<double> &v) const override
+    {
+        double sum = 0;
+        for (double x : v)
+            sum += x;
+        return v.empty() ? 0 : sum / v.size();
+    }
+
+    double optimized(const std::vector<double> &v) const override
+    {
+        // different summation order, so rounding differs slightly
+        double sum = 0;
+        for (auto it = v.rbegin(); it != v.rend(); ++it)
+            sum += *it;
+        return v.empty() ? 0 : sum / v.size();
+    }
+};
+
+} // end DifferentialTestsFixtures
+
+using namespace DifferentialTestsFixtures;
+
+TEST_CASE("matching implementations pass and report speedups",
+          "[differential]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckOutput(SumMatchesReference(), out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.measurements.at("long").count("speedup") == 1);
+    REQUIRE(result.measurements.at("long").count("reference ns") == 1);
+    REQUIRE(result.measurementsBySize.size() > 1);
+    REQUIRE(out.str().find("speedup") != std::string::npos);
+}
+
+TEST_CASE("differing implementations fail with a shrunk input",
+          "[differential]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckOutput(BrokenSum(), out);
+
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(out.str().find("0: [1]") != std::string::npos);
+}
+
+TEST_CASE("floating point outputs are compared with a tolerance",
+          "[differential]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckOutput(MeanWithinTolerance(), out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+}
+
+TEST_CASE("floating point elements of nested containers are compared with "
+          "a tolerance", "[differential]")
+{
+    typedef std::pair<double, double> Point;
+    const std::vector<Point> points = { Point(1.0, 2.0), Point(3.0, 4.0) };
+    const std::vector<Point> nearPoints = { Point(1.0, 2.0 + 1e-12),
+                                            Point(3.0 - 1e-12, 4.0) };
+    REQUIRE(detail::approxEqual(points, nearPoints, 1e-9));
+    REQUIRE(!detail::approxEqual(points, nearPoints, 0.0));
+
+    const std::vector<std::vector<double>> rows = { { 1.0 }, { 2.0, 3.0 } };
+    const std::vector<std::vector<double>> nearRows =
+        { { 1.0 + 1e-12 }, { 2.0, 3.0 - 1e-12 } };
+    REQUIRE(detail::approxEqual(rows, nearRows, 1e-9));
+    REQUIRE(!detail::approxEqual(rows, { { 1.0 }, { 2.0, 3.1 } }, 1e-9));
+}
+
+TEST_CASE("timings are reported with percentiles per size bucket",
+          "[differential]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckOutput(SumMatchesReference(), out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    for (const auto &bucket : result.measurementsBySize) {
+        const MeasurementStats &ns = bucket.second.at("reference ns");
+        REQUIRE(ns.min <= ns.percentile(0.5));
+        REQUIRE(ns.percentile(0.5) <= ns.percentile(0.9));
+        REQUIRE(ns.percentile(0.9) <= ns.percentile(0.99));
+        REQUIRE(ns.percentile(0.99) <= ns.max);
+    }
+    REQUIRE(out.str().find("median/p90/p99") != std::string::npos);
+}
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "catch.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace EdgeCaseTestsFixtures {
+
+// Sets edgeCasePercent for the lifetime of the object.
+struct ScopedEdgeCasePercent
+{
+    explicit ScopedEdgeCasePercent(std::size_t percent) :
+        previous(edgeCasePercent())
+    {
+        edgeCasePercent() = percent;
+    }
+
+    ~ScopedEdgeCasePercent()
+    {
+        edgeCasePercent() = previous;
+    }
+
+    const std::size_t previous;
+};
+
+struct IncrementDoesNotOverflow : cppqc::Property<int>
+{
+    bool check(const int &x) const override
+    {
+        return x != std::numeric_limits<int>::max();
+    }
+};
+
+template<class Integer>
+std::set<Integer> edgeCases(Integer min, Integer max)
+{
+    std::set<Integer> seen;
+    RngEngine rng(42);
+    for (int i = 0; i < 10000; ++i) {
+        const Integer x = detail::edgeCase(rng, min, max);
+        REQUIRE(x >= min);
+        REQUIRE(x <= max);
+        seen.insert(x);
+    }
+    return seen;
+}
+
+} // end EdgeCaseTestsFixtures
+
+using namespace EdgeCaseTestsFixtures;
+
+TEST_CASE("edge cases stay within the range and include its boundaries",
+          "[edge-cases]")
+{
+    const std::set<int> small = edgeCases<int>(-5, 5);
+    REQUIRE(small.count(-5) == 1);
+    REQUIRE(small.count(-4) == 1);
+    REQUIRE(small.count(5) == 1);
+    REQUIRE(small.count(0) == 1);
+
+    REQUIRE(edgeCases<int>(3, 3) == std::set<int>{3});
+    REQUIRE((edgeCases<unsigned char>(0, 255).count(128) == 1));
+
+    typedef std::numeric_limits<std::int64_t> Limits;
+    const std::set<std::int64_t> full =
+        edgeCases<std::int64_t>(Limits::min(), Limits::max());
+    REQUIRE(full.count(Limits::min()) == 1);
+    REQUIRE(full.count(Limits::max() - 1) == 1);
+    REQUIRE(full.count(std::int64_t(1) << 32) == 1);
+    REQUIRE(full.count(-(std::int64_t(1) << 16) - 1) == 1);
+}
+
+TEST_CASE("overflows at the maximum are found in a hundred tests",
+          "[edge-cases]")
+{
+    std::size_t numFound = 0;
+    for (SeedType seed = 0; seed < 20; ++seed) {
+        std::ostringstream out;
+        const Result result = quickCheckOutput(IncrementDoesNotOverflow(),
+            out, 100, 0, 0, DISABLE_SHRINK_TIMEOUT, seed);
+        if (result.result == QC_FAILURE)
+            ++numFound;
+    }
+    REQUIRE(numFound >= 10);
+
+    ScopedEdgeCasePercent disabled(0);
+    REQUIRE(quickCheck(IncrementDoesNotOverflow(), 1000).result ==
+            QC_SUCCESS);
+}
+
+TEST_CASE("without edge cases, choose draws as before", "[edge-cases]")
+{
+    ScopedEdgeCasePercent disabled(0);
+    const StatelessGenerator<int> gen = choose(-1000, 1000);
+    const detail::UniformIntSampler<int> sampler(-1000, 1000);
+    RngEngine rng1(7), rng2(7);
+    for (int i = 0; i < 1000; ++i)
+        REQUIRE(gen.unGen(rng1, 0) == sampler(rng2));
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Enumeration.h"
+#include "cppqc/Exhaustive.h"
+#include "catch.hpp"
+
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace EnumerationTestsFixtures {
+
+std::string node(std::pair<std::string, std::string> children)
+{
+    return "(" + children.first + " " + children.second + ")";
+}
+
+// binary trees, written as "." for a leaf and "(l r)" for a node; the
+// size of a tree is its number of nodes
+Enumeration<std::string> trees()
+{
+    typedef std::pair<std::string, std::string> Children;
+    return enumRecursive<std::string>([](const Enumeration<std::string> &t) {
+        return enumUnion(enumSingleton(std::string(".")),
+            enumPay(enumMap<std::string, Children>(node,
+                                                   enumProduct(t, t))));
+    });
+}
+
+// fails on trees of at least three nodes
+struct SmallTrees : Property<std::string>
+{
+    SmallTrees() : Property(uniformOf(trees())) {}
+
+    bool check(const std::string &t) const override
+    {
+        return std::count(t.begin(), t.end(), '(') < 3;
+    }
+};
+
+struct AnyTree : Property<std::string>
+{
+    AnyTree() : Property(uniformOf(trees())) {}
+
+    bool check(const std::string &) const override
+    {
+        return true;
+    }
+};
+
+} // end EnumerationTestsFixtures
+
+TEST_CASE("enumerations count and index the values of each size",
+          "[enumeration]")
+{
+    const Enumeration<std::vector<bool>> lists = enumListsOf(enumBools());
+    for (std::size_t n = 0; n <= 5; ++n) {
+        const std::size_t count = lists.count(n);
+        REQUIRE(count == (std::size_t(1) << n));
+        std::set<std::vector<bool>> values;
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::vector<bool> v = lists.at(n, i);
+            REQUIRE(v.size() == n);
+            values.insert(v);
+        }
+        REQUIRE(values.size() == count);
+    }
+
+    const Enumeration<int> ints = enumIntegers<int>();
+    REQUIRE(ints.count(0) == 1);
+    REQUIRE(ints.count(3) == 2);
+    REQUIRE(ints.at(3, 0) == 3);
+    REQUIRE(ints.at(3, 1) == -3);
+    REQUIRE(enumIntegers<unsigned char>().count(300) == 0);
+}
+
+TEST_CASE("recursive enumerations count without building the values",
+          "[enumeration]")
+{
+    // the Catalan numbers
+    const Enumeration<std::string> trees = EnumerationTestsFixtures::trees();
+    const std::size_t catalan[] = {1, 1, 2, 5, 14, 42, 132};
+    for (std::size_t n = 0; n < 7; ++n)
+        REQUIRE(trees.count(n) == catalan[n]);
+    REQUIRE(trees.count(35) == 3116285494907301262u);
+    REQUIRE(trees.count(40) == std::numeric_limits<std::size_t>::max());
+    REQUIRE(trees.at(3, 0) == "(. (. (. .)))");
+    REQUIRE(trees.at(35, 3116285494907301261u).size() == 35 * 4 + 1);
+}
+
+TEST_CASE("uniformOf samples every value of a size equally often",
+          "[enumeration]")
+{
+    const Generator<std::string> gen =
+        uniformOf(EnumerationTestsFixtures::trees());
+    RngEngine rng(42);
+    std::map<std::string, std::size_t> counts;
+    for (int i = 0; i < 5000; ++i)
+        ++counts[gen.unGen(rng, 3)];
+    REQUIRE(counts.size() == 5);
+    for (const auto &c : counts) {
+        REQUIRE(c.second > 800);
+        REQUIRE(c.second < 1200);
+    }
+
+    // sizes whose count saturates fall back to smaller ones
+    const std::string big = gen.unGen(rng, 100);
+    REQUIRE(big.size() == 36 * 4 + 1);
+}
+
+TEST_CASE("values of an enumeration shrink to smaller sizes and indices",
+          "[enumeration]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckOutput(
+        EnumerationTestsFixtures::SmallTrees(), out, 100, 0, 0,
+        DISABLE_SHRINK_TIMEOUT, 42);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(out.str().find("(. (. (. .)))") != std::string::npos);
+}
+
+TEST_CASE("enumerations are checked exhaustively by size", "[enumeration]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckExhaustive(
+        EnumerationTestsFixtures::AnyTree(), out, 10, 4);
+    REQUIRE(result.result == QC_SUCCESS);
+    // the trees of up to 10 nodes
+    REQUIRE(result.numTests == 23714);
+
+    std::ostringstream out2;
+    const Result failure = quickCheckExhaustive(
+        EnumerationTestsFixtures::SmallTrees(), out2, 10, 4);
+    REQUIRE(failure.result == QC_FAILURE);
+    REQUIRE(failure.numTests == 1 + 1 + 2 + 1);
+}
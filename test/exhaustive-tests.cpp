@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Exhaustive.h"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace ExhaustiveTestsFixtures {
+
+template<class T>
+std::vector<T> enumerate(const Generator<T> &gen, std::size_t depth)
+{
+    std::vector<T> ret;
+    const std::size_t n = gen.enumSize(depth);
+    for (std::size_t i = 0; i < n; ++i)
+        ret.push_back(gen.enumAt(i, depth));
+    return ret;
+}
+
+struct DeMorgan : Property<bool, bool>
+{
+    bool check(const bool &a, const bool &b) const override
+    {
+        const bool notBoth = !(a && b);
+        return notBoth == (!a || !b);
+    }
+};
+
+struct ReverseIsIdentity : Property<std::vector<int>>
+{
+    ReverseIsIdentity() : numChecks(0) {}
+
+    bool check(const std::vector<int> &v) const override
+    {
+        ++numChecks;
+        return std::vector<int>(v.rbegin(), v.rend()) == v;
+    }
+
+    mutable std::atomic<std::size_t> numChecks;
+};
+
+struct SortIsIdempotent : Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        std::vector<int> once = v;
+        std::sort(once.begin(), once.end());
+        std::vector<int> twice = once;
+        std::sort(twice.begin(), twice.end());
+        return once == twice;
+    }
+};
+
+} // end ExhaustiveTestsFixtures
+
+using ExhaustiveTestsFixtures::enumerate;
+
+TEST_CASE("enumerations of the basic generators", "[exhaustive]")
+{
+    REQUIRE(enumerate<bool>(Arbitrary<bool>(), 3) ==
+            (std::vector<bool>{false, true}));
+    REQUIRE(enumerate<int>(Arbitrary<int>(), 2) ==
+            (std::vector<int>{0, 1, -1, 2, -2}));
+    REQUIRE(enumerate<unsigned>(Arbitrary<unsigned>(), 2) ==
+            (std::vector<unsigned>{0, 1, 2}));
+    REQUIRE(enumerate<signed char>(Arbitrary<signed char>(), 1000).size() ==
+            255);
+
+    REQUIRE(enumerate<int>(choose(3, 10), 2) == (std::vector<int>{3, 4, 5}));
+    REQUIRE(enumerate<int>(choose(-10, -3), 1) ==
+            (std::vector<int>{-3, -4}));
+    REQUIRE(enumerate<int>(choose(0, 3), 100) ==
+            (std::vector<int>{0, 1, 2, 3}));
+    REQUIRE(enumerate<char>(elements({'a', 'b', 'c'}), 1) ==
+            (std::vector<char>{'a', 'b'}));
+
+    const std::vector<std::vector<bool>> lists{{}, {false}, {true},
+        {false, false}, {false, true}, {true, false}, {true, true}};
+    REQUIRE(enumerate<std::vector<bool>>(listOf<bool>(), 2) == lists);
+    REQUIRE(enumerate<std::vector<int>>(listOf<int>(), 1) ==
+            (std::vector<std::vector<int>>{{}, {0}}));
+
+    const std::vector<std::array<bool, 2>> arrays{{{false, false}},
+        {{false, true}}, {{true, false}}, {{true, true}}};
+    REQUIRE((enumerate<std::array<bool, 2>>(arrayOf<bool, 2>(), 0) ==
+             arrays));
+
+    const std::vector<std::tuple<bool, int>> tuples{
+        std::make_tuple(false, 0), std::make_tuple(false, 1),
+        std::make_tuple(false, -1), std::make_tuple(true, 0),
+        std::make_tuple(true, 1), std::make_tuple(true, -1)};
+    REQUIRE((enumerate<std::tuple<bool, int>>(tupleOf<bool, int>(), 1) ==
+             tuples));
+}
+
+TEST_CASE("generators without an enumeration throw NotEnumerable",
+          "[exhaustive]")
+{
+    const Generator<double> real = Arbitrary<double>();
+    REQUIRE_THROWS_AS(real.enumSize(3), const NotEnumerable &);
+    const Generator<int> even =
+        suchThat(choose(0, 10), [](int x) { return x % 2 == 0; });
+    REQUIRE_THROWS_AS(even.enumSize(3), const NotEnumerable &);
+}
+
+TEST_CASE("a property of two bools is checked on all four inputs",
+          "[exhaustive]")
+{
+    std::ostringstream out;
+    const Result result =
+        quickCheckExhaustive(ExhaustiveTestsFixtures::DeMorgan(), out);
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.numTests == 4);
+    REQUIRE(out.str().find("passed 4 tests") != std::string::npos);
+}
+
+TEST_CASE("exhaustive checking stops at the smallest counterexample",
+          "[exhaustive]")
+{
+    // [], [0], [1], [-1], ..., [3], [-3], [0, 0], [0, 1]
+    ExhaustiveTestsFixtures::ReverseIsIdentity serial;
+    std::ostringstream out1;
+    const Result run1 = quickCheckExhaustive(serial, out1, 4, 1);
+    REQUIRE(run1.result == QC_FAILURE);
+    REQUIRE(run1.numTests == 10);
+    REQUIRE(run1.failedTestCase.index == 9);
+    REQUIRE(serial.numChecks.load() == 10);
+    REQUIRE(out1.str().find("[0, 1]") != std::string::npos);
+    // enumerated inputs are not replayed from a seed
+    REQUIRE(out1.str().find("index 9 in the enumeration") !=
+            std::string::npos);
+    REQUIRE(out1.str().find(CPPQUICKCHECK_REPLAY_ENV) == std::string::npos);
+
+    ExhaustiveTestsFixtures::ReverseIsIdentity parallel;
+    std::ostringstream out2;
+    const Result run2 = quickCheckExhaustive(parallel, out2, 4, 4);
+    REQUIRE(run2.numTests == run1.numTests);
+    REQUIRE(out2.str() == out1.str());
+}
+
+TEST_CASE("exhaustive runs report through any reporter", "[exhaustive]")
+{
+    ExhaustiveTestsFixtures::ReverseIsIdentity prop;
+    NullReporter reporter;
+    const Result result = quickCheckExhaustiveReport(prop, reporter, 4, 1);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(result.numTests == 10);
+}
+
+TEST_CASE("exhaustive checking splits the inputs across threads",
+          "[exhaustive]")
+{
+    std::ostringstream out;
+    const Result result = quickCheckExhaustive(
+        ExhaustiveTestsFixtures::SortIsIdempotent(), out, 5, 4);
+    REQUIRE(result.result == QC_SUCCESS);
+    // lists of up to 5 elements in -4..4
+    REQUIRE(result.numTests == 66430);
+}
+
+TEST_CASE("too many inputs to count are rejected", "[exhaustive]")
+{
+    std::ostringstream out;
+    REQUIRE_THROWS_AS(quickCheckExhaustive(
+        ExhaustiveTestsFixtures::SortIsIdempotent(), out, 100),
+        const std::overflow_error &);
+}
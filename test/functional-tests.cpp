@@ -26,6 +26,10 @@
 #include "cppqc.h"
 #include "catch.hpp"
 
+#include <cstdlib>
+#include <map>
+#include <sstream>
+
 using namespace cppqc;
 
 namespace FunctionalTestsFixtures {
@@ -66,6 +70,75 @@ struct NontriviallyFailingProperty : cppqc::Property<std::vector<int>>
     }
 };
 
+struct MeasuringProperty : cppqc::Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        cppqc::recordMeasurement("elements", double(v.size()));
+        return true;
+    }
+    std::string classify(const std::vector<int> &v) const override
+    {
+        return v.empty() ? "empty" : "non-empty";
+    }
+};
+
+struct CountingLateFailure : cppqc::Property<std::vector<int>>
+{
+    CountingLateFailure() : numChecks(0) {}
+
+    bool check(const std::vector<int> &v) const override
+    {
+        ++numChecks;
+        return v.size() < 50;
+    }
+
+    mutable std::size_t numChecks;
+};
+
+struct DistinctBools : cppqc::Property<bool>
+{
+    bool check(const bool &) const override
+    {
+        return true;
+    }
+    bool skipDuplicates() const override
+    {
+        return true;
+    }
+};
+
+struct DistinctInts : cppqc::Property<int>
+{
+    bool check(const int &v) const override
+    {
+        ++checked[v];
+        return true;
+    }
+    bool skipDuplicates() const override
+    {
+        return true;
+    }
+
+    mutable std::map<int, std::size_t> checked;
+};
+
+// Sets an environment variable for the lifetime of the object.
+struct ScopedEnv
+{
+    ScopedEnv(const char *name, const std::string &value) : name(name)
+    {
+        setenv(name, value.c_str(), 1);
+    }
+
+    ~ScopedEnv()
+    {
+        unsetenv(name);
+    }
+
+    const char *name;
+};
+
 } // end FunctionalTestsFixtures
 
 TEST_CASE("minimal passing example",
@@ -108,3 +181,109 @@ TEST_CASE("tests with fixed seeds must be repeatible",
         REQUIRE(output1.str() == output2.str());
     }
 }
+
+TEST_CASE("measurements recorded in checks are aggregated per label",
+          "[functional][measurements]")
+{
+    std::ostringstream out;
+    const Result result =
+        quickCheckOutput(FunctionalTestsFixtures::MeasuringProperty{}, out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.measurements.at("empty").at("elements").max == 0);
+    const MeasurementStats &nonEmpty =
+        result.measurements.at("non-empty").at("elements");
+    REQUIRE(nonEmpty.min >= 1);
+    const std::size_t numMeasured =
+        nonEmpty.count + result.measurements.at("empty").at("elements").count;
+    REQUIRE(numMeasured == result.numTests);
+}
+
+TEST_CASE("measurement percentiles are within a bucket of the exact value",
+          "[functional][measurements]")
+{
+    MeasurementStats stats;
+    for (int i = 100; i >= -99; --i)
+        stats.add(i);
+
+    REQUIRE(stats.percentile(0.0) == Approx(-99).epsilon(0.01));
+    REQUIRE(stats.percentile(0.5) == 0);
+    REQUIRE(stats.percentile(0.9) == Approx(80).epsilon(0.01));
+    REQUIRE(stats.percentile(1.0) == Approx(100).epsilon(0.01));
+}
+
+TEST_CASE("a failing test case can be replayed on its own",
+          "[functional][seed]")
+{
+    FunctionalTestsFixtures::CountingLateFailure fullRun;
+    std::ostringstream output1;
+    const Result run1 = quickCheckOutput(fullRun, output1, 100, 0, 0,
+                                         DISABLE_SHRINK_TIMEOUT, 42);
+    REQUIRE(run1.result == QC_FAILURE);
+    REQUIRE(run1.failedTestCase.seed == 42);
+    REQUIRE(run1.failedTestCase.index == run1.numTests - 1);
+    REQUIRE(run1.failedTestCase.size == run1.usedSize);
+
+    std::ostringstream id;
+    id << run1.failedTestCase;
+    REQUIRE(output1.str().find(std::string(CPPQUICKCHECK_REPLAY_ENV) + '=' +
+                               id.str()) != std::string::npos);
+
+    FunctionalTestsFixtures::ScopedEnv replay(CPPQUICKCHECK_REPLAY_ENV,
+                                              id.str());
+    FunctionalTestsFixtures::CountingLateFailure replayRun;
+    std::ostringstream output2;
+    const Result run2 = quickCheckOutput(replayRun, output2);
+    REQUIRE(run2.result == QC_FAILURE);
+    REQUIRE(run2.numTests == 1);
+    REQUIRE(run2.numShrinks == run1.numShrinks);
+    // the passing test cases before the failure are not checked again
+    const std::size_t skippedChecks = fullRun.numChecks - replayRun.numChecks;
+    REQUIRE(skippedChecks == run1.failedTestCase.index);
+}
+
+TEST_CASE("malformed replay test cases are rejected", "[functional][seed]")
+{
+    FunctionalTestsFixtures::ScopedEnv replay(CPPQUICKCHECK_REPLAY_ENV,
+                                              "42:7");
+    std::ostringstream out;
+    REQUIRE_THROWS_AS(
+        quickCheckOutput(FunctionalTestsFixtures::CountingLateFailure(), out),
+        const std::invalid_argument &);
+}
+
+TEST_CASE("every checked shrink candidate is counted", "[functional][shrink]")
+{
+    FunctionalTestsFixtures::CountingLateFailure prop;
+    const Result result = quickCheck(prop);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(result.numShrinkEvaluations >= result.numShrinks);
+    const std::size_t shrinkChecks = prop.numChecks - result.numTests;
+    REQUIRE(shrinkChecks == result.numShrinkEvaluations);
+}
+
+TEST_CASE("duplicate inputs are skipped if the property asks for it",
+          "[functional][duplicates]")
+{
+    FunctionalTestsFixtures::DistinctInts prop;
+    std::ostringstream out;
+    const Result result = quickCheckOutput(prop, out, 100, 0, 0,
+                                           DISABLE_SHRINK_TIMEOUT, 42);
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.numTests == 100);
+    REQUIRE(result.numDuplicates > 0);
+    REQUIRE(prop.checked.size() == 100);
+    for (const auto &count : prop.checked)
+        REQUIRE(count.second == 1);
+    REQUIRE(out.str().find("duplicates skipped") != std::string::npos);
+}
+
+TEST_CASE("a run passes once the duplicates show the inputs are exhausted",
+          "[functional][duplicates]")
+{
+    const Result result = quickCheck(FunctionalTestsFixtures::DistinctBools(),
+                                     100, 50);
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.numTests == 2);
+    REQUIRE(result.numDuplicates == 50);
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Fuzz.h"
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace FuzzTestsFixtures {
+
+struct ShorterThan3 : Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        return v.size() < 3;
+    }
+};
+
+void appendWord(std::vector<std::uint8_t> &data, std::uint32_t word)
+{
+    for (int i = 0; i < 4; ++i)
+        data.push_back(std::uint8_t(word >> (8 * i)));
+}
+
+// size 100, the longest list, and enough choices for its elements
+std::vector<std::uint8_t> longListData()
+{
+    std::vector<std::uint8_t> data;
+    appendWord(data, 100);
+    appendWord(data, 0xffffffffu);
+    for (int i = 0; i < 1000; ++i)
+        appendWord(data, 0x80000000u);
+    return data;
+}
+
+struct CrashFile
+{
+    CrashFile(const std::vector<std::uint8_t> &data) :
+        path("cppqc-fuzz-test.crash")
+    {
+        std::ofstream out(path.c_str(), std::ios::binary);
+        out.write(reinterpret_cast<const char *>(data.data()), data.size());
+        setenv(CPPQUICKCHECK_FUZZ_INPUT_ENV, path.c_str(), 1);
+    }
+
+    ~CrashFile()
+    {
+        unsetenv(CPPQUICKCHECK_FUZZ_INPUT_ENV);
+        std::remove(path.c_str());
+    }
+
+    std::string path;
+};
+
+}
+
+using namespace FuzzTestsFixtures;
+
+TEST_CASE("fuzzer data is decoded into a size and choices", "[fuzz]")
+{
+    const std::uint8_t data[] = { 105, 0, 0, 0, 1, 2, 3, 4, 9 };
+    std::size_t size;
+    Choices choices;
+    detail::decodeFuzzInput(data, sizeof(data), 100, size, choices);
+    REQUIRE(size == 4);
+    REQUIRE(choices == (Choices{0x04030201u, 9}));
+}
+
+TEST_CASE("fuzzCheck checks the input generated from the data", "[fuzz]")
+{
+    std::ostringstream out;
+    const std::vector<std::uint8_t> failing = longListData();
+    REQUIRE(fuzzCheck(ShorterThan3(), failing.data(), failing.size(), 100,
+                      out) == FUZZ_FAILED);
+    REQUIRE(out.str().find(CPPQUICKCHECK_FUZZ_INPUT_ENV) !=
+            std::string::npos);
+
+    // an empty list
+    std::vector<std::uint8_t> passing;
+    appendWord(passing, 100);
+    appendWord(passing, 0x01000000u);
+    REQUIRE(fuzzCheck(ShorterThan3(), passing.data(), passing.size()) ==
+            FUZZ_PASSED);
+
+    // too few choices for a list of 100 elements: the rest are zeros
+    const std::vector<std::uint8_t> truncated(failing.begin(),
+                                              failing.begin() + 12);
+    REQUIRE(fuzzCheck(ShorterThan3(), truncated.data(), truncated.size(),
+                      100, out) == FUZZ_FAILED);
+
+    // no data at all generates the smallest input
+    REQUIRE(fuzzCheck(ShorterThan3(), nullptr, 0) == FUZZ_PASSED);
+}
+
+TEST_CASE("a crash file is checked and shrunk by the runner", "[fuzz]")
+{
+    CrashFile crash(longListData());
+    std::ostringstream out;
+    const Result result = quickCheckOutput(ShorterThan3(), out);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(result.numTests == 1);
+    REQUIRE(result.usedSize == 100);
+    REQUIRE(result.numShrinks > 0);
+    REQUIRE(result.failedTestCase.reproduction.find(crash.path) !=
+            std::string::npos);
+    REQUIRE(out.str().find(CPPQUICKCHECK_FUZZ_INPUT_ENV + std::string("=") +
+                           crash.path) != std::string::npos);
+    REQUIRE(out.str().find(CPPQUICKCHECK_REPLAY_ENV) == std::string::npos);
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Memory.h"
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace cppqc;
+
+namespace MemoryTestsFixtures {
+
+struct CopyIsBounded : MemoryProperty<std::vector<int>>
+{
+    explicit CopyIsBounded(std::size_t maxBytes) : MemoryProperty(maxBytes) {}
+
+    void run(const std::vector<int> &v) const override
+    {
+        std::vector<int> copy(v);
+    }
+};
+
+// Memoizes every input and never evicts anything.
+struct UnboundedCache : MemoryProperty<std::vector<int>>
+{
+    UnboundedCache() : MemoryProperty(std::size_t(-1)) {}
+
+    void run(const std::vector<int> &v) const override
+    {
+        cache.push_back(std::unique_ptr<int>(new int(int(v.size()))));
+    }
+
+    mutable std::vector<std::unique_ptr<int>> cache;
+};
+
+} // end MemoryTestsFixtures
+
+using namespace MemoryTestsFixtures;
+
+TEST_CASE("allocation counter tracks the peak and retained heap bytes",
+          "[memory]")
+{
+    AllocationCounter counter;
+    int *volatile kept = new int[64];
+    int *volatile temporary = new int[256];
+    delete[] temporary;
+    const std::ptrdiff_t peak = counter.peakBytes();
+    const std::ptrdiff_t retained = counter.retainedBytes();
+    delete[] kept;
+
+    REQUIRE(peak == std::ptrdiff_t(320 * sizeof(int)));
+    REQUIRE(retained == std::ptrdiff_t(64 * sizeof(int)));
+}
+
+TEST_CASE("memory property reports the peak input without flagging growth",
+          "[memory]")
+{
+    CopyIsBounded prop(std::size_t(-1));
+    std::ostringstream out;
+    const MemoryResult result = quickCheckMemory(prop, out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE_FALSE(result.memoryGrowth);
+    REQUIRE(result.retainedBytes == 0);
+    REQUIRE(prop.peakInput() != nullptr);
+    const std::size_t peakLength = std::get<0>(*prop.peakInput()).size();
+    REQUIRE(prop.peakBytes() == std::ptrdiff_t(peakLength * sizeof(int)));
+    REQUIRE(out.str().find("Peak heap usage") != std::string::npos);
+}
+
+TEST_CASE("memory-hungry input is shrunk to a small counterexample",
+          "[memory]")
+{
+    CopyIsBounded prop(10 * sizeof(int));
+    std::ostringstream out;
+    const MemoryResult result = quickCheckMemory(prop, out, 100, 0, 0,
+        DISABLE_SHRINK_TIMEOUT, 0);
+
+    REQUIRE(result.result == QC_FAILURE);
+    // eleven elements are the smallest input above the limit
+    REQUIRE(prop.lastFailureCost() == 11 * sizeof(int));
+    REQUIRE(out.str().find("Peak heap bytes of the counterexample") !=
+            std::string::npos);
+}
+
+TEST_CASE("growing cache is flagged as memory growth", "[memory]")
+{
+    UnboundedCache prop;
+    std::ostringstream out;
+    const MemoryResult result = quickCheckMemory(prop, out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.memoryGrowth);
+    REQUIRE(result.retainedBytes >= std::ptrdiff_t(100 * sizeof(int)));
+    REQUIRE(out.str().find("Memory grows across checks") != std::string::npos);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Mutate.h"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace MutateTestsFixtures {
+
+const int MAGIC = 1000000;
+
+// Fails on three magic numbers, which are never generated from scratch.
+struct FewMagicNumbers : Property<std::vector<int>>
+{
+    FewMagicNumbers() {}
+
+    explicit FewMagicNumbers(const StatelessGenerator<std::vector<int>> &g) :
+        Property(g)
+    {
+    }
+
+    bool check(const std::vector<int> &v) const override
+    {
+        return std::count(v.begin(), v.end(), MAGIC) < 3;
+    }
+};
+
+struct Opaque
+{
+    int value;
+};
+
+}
+
+using namespace MutateTestsFixtures;
+
+TEST_CASE("mutations explore around the seeds", "[mutate]")
+{
+    const std::vector<std::vector<int>> seeds{{MAGIC, 0, MAGIC}};
+
+    std::ostringstream random;
+    REQUIRE(quickCheckOutput(FewMagicNumbers(), random, 1000, 0, 0,
+                             DISABLE_SHRINK_TIMEOUT, 42).result ==
+            QC_SUCCESS);
+
+    std::ostringstream mutated;
+    const Result result =
+        quickCheckOutput(FewMagicNumbers(mutate(seeds)), mutated, 1000, 0, 0,
+                         DISABLE_SHRINK_TIMEOUT, 42);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(result.numTests < 100);
+    REQUIRE(mutated.str().find("0: [1000000, 1000000, 1000000]") !=
+            std::string::npos);
+}
+
+TEST_CASE("mutated values are determined by the seed", "[mutate]")
+{
+    const StatelessGenerator<std::string> gen =
+        mutate(std::vector<std::string>{"hello", "world"});
+    RngEngine rng1(3), rng2(3);
+    for (std::size_t size = 0; size < 100; ++size)
+        REQUIRE(gen.unGen(rng1, size) == gen.unGen(rng2, size));
+
+    REQUIRE_THROWS_AS(mutate(std::vector<int>()),
+                      const std::invalid_argument &);
+}
+
+TEST_CASE("tuples mutate the elements that have mutations", "[mutate]")
+{
+    REQUIRE((Mutations<std::tuple<Opaque, int>>::supported));
+    REQUIRE(!(Mutations<std::tuple<Opaque>>::supported));
+    REQUIRE(!(Mutations<std::pair<Opaque, Opaque>>::supported));
+
+    RngEngine rng(5);
+    std::size_t numChanged = 0;
+    for (int i = 0; i < 100; ++i) {
+        std::tuple<Opaque, int> x(Opaque{1}, 0);
+        Mutations<std::tuple<Opaque, int>>::mutate(rng, x, 10);
+        REQUIRE(std::get<0>(x).value == 1);
+        if (std::get<1>(x) != 0)
+            ++numChanged;
+    }
+    REQUIRE(numChanged > 50);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/PerfCounters.h"
+#include "catch.hpp"
+
+#include <numeric>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace PerfCounterTestsFixtures {
+
+struct SumIsNotNegative : Property<std::vector<unsigned>>
+{
+    bool check(const std::vector<unsigned> &v) const override
+    {
+        volatile unsigned long long sum =
+            std::accumulate(v.begin(), v.end(), 0ULL);
+        return sum + 1 > 0;
+    }
+};
+
+struct BoundedInstructions : Property<std::vector<unsigned>>
+{
+    bool check(const std::vector<unsigned> &v) const override
+    {
+        PerfCounters counters;
+        const PerfCounterValues values = counters.measure([&] {
+            volatile unsigned long long sum =
+                std::accumulate(v.begin(), v.end(), 0ULL);
+            (void)sum;
+        });
+        return values.atMost(PERF_INSTRUCTIONS, 1e6 + 1000.0 * v.size());
+    }
+};
+
+} // end PerfCounterTestsFixtures
+
+using namespace PerfCounterTestsFixtures;
+
+TEST_CASE("perf counter probe records counters or falls back to wall time",
+          "[perf-counters]")
+{
+    PerfCounterProbe probe;
+    ProbeRegistration registration(probe);
+    std::ostringstream out;
+    const Result result = quickCheckOutput(SumIsNotNegative(), out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    const MeasurementTable &table = result.measurements.at("");
+    if (probe.available()) {
+        const std::size_t counted =
+            table.count("cycles") + table.count("instructions");
+        REQUIRE(counted > 0);
+        REQUIRE(table.count("wall ns") == 0);
+    } else {
+        REQUIRE(table.at("wall ns").count == result.numTests);
+    }
+}
+
+TEST_CASE("bounds on unavailable counters are reported as unchecked",
+          "[perf-counters]")
+{
+    PerfCounterValues values;
+    values.wallNanoseconds = 100;
+    REQUIRE_FALSE(values.has(PERF_INSTRUCTIONS));
+    REQUIRE(values.atMost(PERF_INSTRUCTIONS, 0));
+    REQUIRE(values.atMost(PERF_INSTRUCTIONS, 0, 100));
+    REQUIRE_FALSE(values.atMost(PERF_INSTRUCTIONS, 1e9, 99));
+
+    std::ostringstream out;
+    const Result result = quickCheckOutput(BoundedInstructions(), out);
+    REQUIRE(result.result == QC_SUCCESS);
+    const MeasurementTable &table = result.measurements.at("");
+    if (PerfCounters().available()) {
+        REQUIRE(table.count("unchecked instructions bound") == 0);
+    } else {
+        REQUIRE(table.at("unchecked instructions bound").count ==
+                result.numTests);
+        REQUIRE(out.str().find("unchecked instructions bound") !=
+                std::string::npos);
+    }
+
+    PerfCounters counters;
+    const PerfCounterValues measured = counters.measure([] {
+        volatile int x = 0;
+        for (int i = 0; i < 1000; ++i)
+            x = x + i;
+    });
+    REQUIRE(measured.wallNanoseconds >= 0);
+    if (!counters.available())
+        REQUIRE_FALSE(measured.has(PERF_INSTRUCTIONS));
+    if (measured.has(PERF_INSTRUCTIONS)) {
+        REQUIRE(measured[PERF_INSTRUCTIONS] > 1000);
+        REQUIRE_FALSE(measured.atMost(PERF_INSTRUCTIONS, 1));
+    }
+}
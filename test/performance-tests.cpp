@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc/Performance.h"
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace cppqc;
+
+namespace PerformanceTestsFixtures {
+
+// Insertion sort, measured by the number of element moves, which grows
+// with the number of inversions in the input.
+struct InsertionSortMoves : PerformanceProperty<std::vector<int>>
+{
+    explicit InsertionSortMoves(double threshold) :
+        PerformanceProperty(threshold) {}
+
+    double cost(const std::vector<int> &v) const override
+    {
+        std::vector<int> copy(v);
+        std::size_t moves = 0;
+        for (std::size_t i = 1; i < copy.size(); ++i) {
+            for (std::size_t j = i; j > 0 && copy[j - 1] > copy[j]; --j) {
+                std::swap(copy[j - 1], copy[j]);
+                ++moves;
+            }
+        }
+        return double(moves);
+    }
+
+    std::size_t repetitions() const override
+    {
+        return 1;
+    }
+};
+
+} // end PerformanceTestsFixtures
+
+using namespace PerformanceTestsFixtures;
+
+TEST_CASE("performance property shrinks to a small input above the threshold",
+          "[performance]")
+{
+    InsertionSortMoves prop(5);
+    std::ostringstream out;
+    const Result result = quickCheckPerformance(prop, out, 100, 0, 0,
+        DISABLE_SHRINK_TIMEOUT, 0);
+
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(prop.lastFailureCost() > prop.threshold());
+    // the shrunk input stays above the threshold, but only barely
+    REQUIRE(prop.lastFailureCost() <= 10);
+    REQUIRE(out.str().find("Cost of the counterexample") != std::string::npos);
+}
+
+TEST_CASE("performance property passes when the cost stays below the threshold",
+          "[performance]")
+{
+    InsertionSortMoves prop(1e9);
+    std::ostringstream out;
+    const Result result = quickCheckPerformance(prop, out);
+
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.measurements.at("").at("cost").count == result.numTests);
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "catch.hpp"
+
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace PrettyPrintTestsFixtures {
+
+// Restores the process-wide print limits after a test.
+struct ScopedPrintLimits
+{
+    ScopedPrintLimits() : saved(printLimits()) {}
+    ~ScopedPrintLimits() { printLimits() = saved; }
+
+    const PrintLimits saved;
+};
+
+struct Opaque
+{
+    int id;
+};
+
+struct ShortVectors : Property<std::vector<int>>
+{
+    bool check(const std::vector<int> &v) const override
+    {
+        return v.size() < 5;
+    }
+};
+
+struct DistinctBoolArrays : Property<std::array<bool, 2>>
+{
+    bool check(const std::array<bool, 2> &) const override
+    {
+        return true;
+    }
+    bool skipDuplicates() const override
+    {
+        return true;
+    }
+};
+
+} // end PrettyPrintTestsFixtures
+
+namespace cppqc {
+    template<>
+    struct PrettyPrint<PrettyPrintTestsFixtures::Opaque>
+    {
+        static std::string toString(const PrettyPrintTestsFixtures::Opaque &x)
+        {
+            return "opaque#" + std::to_string(x.id);
+        }
+    };
+}
+
+using namespace PrettyPrintTestsFixtures;
+
+TEST_CASE("long containers print their head and tail", "[pretty-print]")
+{
+    ScopedPrintLimits scoped;
+    printLimits().maxElements = 6;
+
+    std::vector<int> v(1000);
+    for (int i = 0; i < 1000; ++i)
+        v[i] = i;
+    REQUIRE(prettyPrint(v) == "[0, 1, 2, ... 994 more ..., 997, 998, 999]");
+
+    const std::vector<int> shortVector = {1, 2, 3};
+    REQUIRE(prettyPrint(shortVector) == "[1, 2, 3]");
+
+    const std::vector<std::vector<int>> nested(10, shortVector);
+    printLimits().maxElements = 2;
+    REQUIRE(prettyPrint(nested) ==
+            "[[1, ... 1 more ..., 3], ... 8 more ..., [1, ... 1 more ..., 3]]");
+}
+
+TEST_CASE("pretty-printing keeps the format of pairs, maps and strings",
+          "[pretty-print]")
+{
+    const std::map<int, std::string> m = {{1, "a"}, {2, "b"}};
+    REQUIRE(prettyPrint(m) == "[(1, \"a\"), (2, \"b\")]");
+    REQUIRE(prettyPrint(std::string("x")) == "\"x\"");
+
+    const std::vector<Opaque> opaque = {{1}, {2}};
+    REQUIRE(prettyPrint(opaque) == "[opaque#1, opaque#2]");
+}
+
+TEST_CASE("printed arguments are cut after the byte limit", "[pretty-print]")
+{
+    ScopedPrintLimits scoped;
+    printLimits().maxBytes = 20;
+
+    std::ostringstream out;
+    printInput(out, std::make_tuple(std::string(10000, 'x'), 42));
+    const std::string printed = out.str();
+    REQUIRE(printed.size() < 100);
+    REQUIRE(printed.find("cut after 20 bytes") != std::string::npos);
+    REQUIRE(printed.find("1: 42") != std::string::npos);
+}
+
+TEST_CASE("counterexamples can be dumped in binary form", "[pretty-print]")
+{
+    ScopedPrintLimits scoped;
+    printLimits().dumpFile = "cppqc-pretty-print-test.dump";
+    std::remove(printLimits().dumpFile.c_str());
+
+    std::ostringstream out;
+    const Result result = quickCheckOutput(ShortVectors(), out);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(out.str().find("Full input dumped to") != std::string::npos);
+
+    std::ifstream file(printLimits().dumpFile.c_str(), std::ios::binary);
+    const std::string bytes((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+    std::uint64_t count = 0;
+    REQUIRE(bytes.size() == sizeof(count) + 5 * sizeof(int));
+    std::copy(bytes.begin(), bytes.begin() + sizeof(count),
+              reinterpret_cast<char *>(&count));
+    REQUIRE(count == 5);
+    std::remove(printLimits().dumpFile.c_str());
+}
+
+TEST_CASE("arrays of plain values can be dumped", "[pretty-print]")
+{
+    typedef std::array<int, 3> Ints;
+    typedef std::tuple<Ints, std::array<bool, 2>> Input;
+    REQUIRE(BinaryDump<Ints>::supported);
+    REQUIRE(BinaryDump<Input>::supported);
+
+    const Ints a = {{ 1, 2, 3 }};
+    std::ostringstream out;
+    BinaryDump<Ints>::write(out, a);
+    const std::string bytes = out.str();
+    std::uint64_t count = 0;
+    REQUIRE(bytes.size() == sizeof(count) + 3 * sizeof(int));
+    std::copy(bytes.begin(), bytes.begin() + sizeof(count),
+              reinterpret_cast<char *>(&count));
+    REQUIRE(count == 3);
+
+    // duplicate suppression hashes the dump of the input
+    std::ostringstream report;
+    const Result result = quickCheckOutput(DistinctBoolArrays(), report);
+    REQUIRE(result.result == QC_SUCCESS);
+    REQUIRE(result.numDuplicates > 0);
+}
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "catch.hpp"
+
+#include <set>
+#include <sstream>
+#include <utility>
+
+using namespace cppqc;
+
+namespace QuasiRandomTestsFixtures {
+
+// Sets quasiRandom for the lifetime of the object.
+struct ScopedQuasiRandom
+{
+    explicit ScopedQuasiRandom(bool quasi) : previous(quasiRandom())
+    {
+        quasiRandom() = quasi;
+    }
+
+    ~ScopedQuasiRandom()
+    {
+        quasiRandom() = previous;
+    }
+
+    const bool previous;
+};
+
+// Records the cells of a 10x10 grid the inputs fall into.
+struct GridCells : Property<int, int>
+{
+    GridCells() : Property(choose(0, 9), choose(0, 9)) {}
+
+    bool check(const int &x, const int &y) const override
+    {
+        cells.insert(std::make_pair(x, y));
+        return true;
+    }
+
+    mutable std::set<std::pair<int, int>> cells;
+};
+
+// Fails in a small corner of the square.
+struct AwayFromTheCorner : Property<int, int>
+{
+    AwayFromTheCorner() : Property(choose(0, 99), choose(0, 99)) {}
+
+    bool check(const int &x, const int &y) const override
+    {
+        return x < 97 || y < 97;
+    }
+};
+
+Generator<std::tuple<int, int>> point()
+{
+    const Generator<int> coordinate = choose(0, 99);
+    return tupleOf(coordinate, coordinate);
+}
+
+// Records how often both tuples of a test case are equal.
+struct TwoPoints : Property<std::tuple<int, int>, std::tuple<int, int>>
+{
+    TwoPoints() : Property(point(), point()) {}
+
+    bool check(const std::tuple<int, int> &a,
+               const std::tuple<int, int> &b) const override
+    {
+        if (a == b)
+            ++numEqual;
+        return true;
+    }
+
+    mutable std::size_t numEqual = 0;
+};
+
+struct AnyInts : Property<int, int>
+{
+    bool check(const int &, const int &) const override
+    {
+        return true;
+    }
+};
+
+// AwayFromTheCorner, shrunk on its choices
+struct AwayFromTheCornerOnChoices : AwayFromTheCorner
+{
+    ShrinkStrategy shrinkStrategy() const override
+    {
+        return SHRINK_CHOICES;
+    }
+};
+
+struct CapturingReporter : NullReporter
+{
+    template<class Input>
+    void failed(const PropertyBase &, std::size_t, std::size_t,
+                const Input &in, const TestCaseId &)
+    {
+        counterexample = std::make_pair(std::get<0>(in), std::get<1>(in));
+    }
+
+    std::pair<int, int> counterexample;
+};
+
+std::size_t numCells(SeedType seed)
+{
+    GridCells prop;
+    std::ostringstream out;
+    quickCheckOutput(prop, out, 100, 0, 0, DISABLE_SHRINK_TIMEOUT, seed);
+    return prop.cells.size();
+}
+
+}
+
+using namespace QuasiRandomTestsFixtures;
+
+TEST_CASE("quantiles map to values in order", "[quasi-random]")
+{
+    const StatelessGenerator<int> digits = choose(0, 9);
+    REQUIRE(digits.hasQuantile());
+    REQUIRE(digits.quantileTree(0.0, 0).value() == 0);
+    REQUIRE(digits.quantileTree(0.55, 0).value() == 5);
+    REQUIRE(digits.quantileTree(0.9999, 0).value() == 9);
+
+    const StatelessGenerator<double> reals = Arbitrary<double>();
+    REQUIRE(reals.hasQuantile());
+    REQUIRE(reals.quantileTree(0.0, 9).value() == -10.0);
+    REQUIRE(reals.quantileTree(0.75, 9).value() == 5.0);
+
+    const StatelessGenerator<int> ints = Arbitrary<int>();
+    REQUIRE(ints.hasQuantile());
+    REQUIRE(ints.quantileTree(0.5, 10).value() == 0);
+    REQUIRE(ints.quantileTree(0.25, 10).value() < 0);
+    REQUIRE(ints.quantileTree(0.75, 10).value() == 10);
+    REQUIRE(ints.quantileTree(0.75, 10).value() ==
+            -ints.quantileTree(0.25, 10).value());
+    REQUIRE(ints.quantileTree(0.9999, 10).value() > 10);
+
+    const StatelessGenerator<unsigned> naturals = Arbitrary<unsigned>();
+    REQUIRE(naturals.quantileTree(0.5, 10).value() == 10);
+
+    const StatelessGenerator<bool> bools = Arbitrary<bool>();
+    REQUIRE(!bools.hasQuantile());
+    REQUIRE_THROWS_AS(bools.quantileTree(0.5, 10), const NoQuantile &);
+}
+
+TEST_CASE("quasi-random runs cover the input space more evenly",
+          "[quasi-random]")
+{
+    std::size_t random = 0, quasi = 0;
+    for (SeedType seed = 0; seed < 10; ++seed) {
+        {
+            ScopedQuasiRandom off(false);
+            random += numCells(seed);
+        }
+        ScopedQuasiRandom on(true);
+        quasi += numCells(seed);
+    }
+    // independent draws hit about 63 of the 100 cells, the first 100
+    // points of the Halton sequence in bases 2 and 3 about 77
+    REQUIRE(random < 700);
+    REQUIRE(quasi > 740);
+}
+
+TEST_CASE("quasi-random test cases are determined by their id",
+          "[quasi-random]")
+{
+    ScopedQuasiRandom on(true);
+    std::ostringstream out1, out2;
+    const Result run1 = quickCheckOutput(AwayFromTheCorner(), out1, 1000, 0,
+                                         0, DISABLE_SHRINK_TIMEOUT, 7);
+    const Result run2 = quickCheckOutput(AwayFromTheCorner(), out2, 1000, 0,
+                                         0, DISABLE_SHRINK_TIMEOUT, 7);
+    REQUIRE(run1.result == QC_FAILURE);
+    REQUIRE(out1.str() == out2.str());
+
+    // the failing test case regenerates the same input on its own
+    RngEngine rng = detail::testCaseRng(run1.failedTestCase);
+    const std::tuple<int, int> in =
+        AwayFromTheCorner().generateInput(rng, run1.usedSize);
+    REQUIRE(!AwayFromTheCorner().checkInput(in));
+}
+
+TEST_CASE("the tuples of a test case take points of their own",
+          "[quasi-random]")
+{
+    ScopedQuasiRandom on(true);
+    TwoPoints prop;
+    std::ostringstream out;
+    quickCheckOutput(prop, out, 100, 0, 0, DISABLE_SHRINK_TIMEOUT, 3);
+    REQUIRE(prop.numEqual < 5);
+}
+
+TEST_CASE("arbitrary integers are quasi-random too", "[quasi-random]")
+{
+    ScopedQuasiRandom on(true);
+    // the values depend on the position in the run, not on the engine
+    RngEngine rng1(1), rng2(2);
+    rng1.setRunPosition(7, 3);
+    rng2.setRunPosition(7, 3);
+    REQUIRE(AnyInts().generateInput(rng1, 50) ==
+            AnyInts().generateInput(rng2, 50));
+}
+
+TEST_CASE("quasi-random inputs are shrunk and replayed on their choices",
+          "[quasi-random]")
+{
+    ScopedQuasiRandom on(true);
+    AwayFromTheCornerOnChoices prop;
+    CapturingReporter reporter;
+    const Result result = quickCheckReport(prop, reporter, 1000, 0, 0,
+                                           DISABLE_SHRINK_TIMEOUT, 7);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(!result.failedChoices.empty());
+    REQUIRE(reporter.counterexample == std::make_pair(97, 97));
+
+    const std::tuple<int, int> replayed =
+        generateFromChoices(prop, result.failedChoices, result.usedSize);
+    REQUIRE(replayed == std::make_tuple(97, 97));
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace cppqc;
+
+namespace ReporterTestsFixtures {
+
+int timesPrinted = 0;
+
+struct Printed
+{
+    int value;
+};
+
+std::ostream &operator<<(std::ostream &out, const Printed &p)
+{
+    ++timesPrinted;
+    return out << p.value;
+}
+
+struct PrintedGenerator
+{
+    Printed unGen(RngEngine &rng, std::size_t size) const
+    {
+        Printed p = { int(detail::uniformInt<std::size_t>(rng, 0, size)) };
+        return p;
+    }
+
+    std::vector<Printed> shrink(const Printed &p) const
+    {
+        std::vector<Printed> ret;
+        if (p.value > 0) {
+            Printed smaller = { p.value / 2 };
+            ret.push_back(smaller);
+        }
+        return ret;
+    }
+};
+
+struct PrintedIsSmall : Property<Printed>
+{
+    PrintedIsSmall() : Property(Generator<Printed>(PrintedGenerator())) {}
+
+    bool check(const Printed &p) const override
+    {
+        return p.value < 10;
+    }
+};
+
+struct CountingReporter
+{
+    CountingReporter() : starts(0), failures(0), passes(0), shrinks(0) {}
+
+    void start(const PropertyBase &) { ++starts; }
+    void exceptionCaught() {}
+    void shrinkTimedOut() {}
+
+    template<class Input>
+    void failed(const PropertyBase &, std::size_t, std::size_t numShrinks,
+                const Input &in, const TestCaseId &)
+    {
+        ++failures;
+        shrinks = numShrinks;
+        failedValue = std::get<0>(in).value;
+    }
+
+    void gaveUp(std::size_t) {}
+    void passed(const PropertyBase &, std::size_t, const Result &)
+    {
+        ++passes;
+    }
+
+    int starts, failures, passes;
+    std::size_t shrinks;
+    int failedValue;
+};
+
+} // end ReporterTestsFixtures
+
+using namespace ReporterTestsFixtures;
+
+TEST_CASE("silent runs do not pretty-print the counterexample", "[reporter]")
+{
+    timesPrinted = 0;
+    const Result result = quickCheck(PrintedIsSmall());
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(timesPrinted == 0);
+
+    std::ostringstream out;
+    quickCheckOutput(PrintedIsSmall(), out);
+    REQUIRE(timesPrinted == 1);
+}
+
+TEST_CASE("custom reporters receive the events of a run", "[reporter]")
+{
+    CountingReporter reporter;
+    const Result result = quickCheckReport(PrintedIsSmall(), reporter);
+
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(reporter.starts == 1);
+    REQUIRE(reporter.failures == 1);
+    REQUIRE(reporter.passes == 0);
+    REQUIRE(reporter.shrinks == result.numShrinks);
+    REQUIRE(reporter.failedValue >= 10);
+    REQUIRE(reporter.failedValue < 20);
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "catch.hpp"
+
+#include <string>
+
+using namespace cppqc;
+
+namespace ShrinkTreeTestsFixtures {
+
+// has no operator==, so it could not be looked up in a list of values
+struct Box
+{
+    int x;
+};
+
+Box makeBox(int x)
+{
+    Box b = { x };
+    return b;
+}
+
+struct Point
+{
+    int x;
+    int y;
+};
+
+Point makePoint(int x, int y)
+{
+    Point p = { x, y };
+    return p;
+}
+
+std::vector<int> halve(int x)
+{
+    std::vector<int> ret;
+    if (x > 0)
+        ret.push_back(x / 2);
+    return ret;
+}
+
+bool isEven(int x)
+{
+    return x % 2 == 0;
+}
+
+struct BoxBelow10 : Property<Box>
+{
+    BoxBelow10() :
+        Property(convert<Box, int>(makeBox, choose(0, 1000)))
+    {
+    }
+
+    bool check(const Box &b) const override
+    {
+        return b.x < 10;
+    }
+};
+
+struct PointNearOrigin : Property<Point>
+{
+    PointNearOrigin() :
+        Property(combine<Point, int, int>(makePoint, choose(0, 1000),
+                                          choose(0, 1000)))
+    {
+    }
+
+    bool check(const Point &p) const override
+    {
+        return p.x + p.y < 10;
+    }
+};
+
+struct EvenBelow101 : Property<int>
+{
+    EvenBelow101() : Property(suchThat(choose(0, 1000), isEven)) {}
+
+    bool check(const int &x) const override
+    {
+        return x < 101;
+    }
+};
+
+template<class Input>
+struct CapturingReporter : NullReporter
+{
+    void failed(const PropertyBase &, std::size_t, std::size_t,
+                const Input &in, const TestCaseId &)
+    {
+        counterexample = in;
+    }
+
+    Input counterexample;
+};
+
+template<class Prop>
+typename Prop::Input shrunkCounterexample(const Prop &prop)
+{
+    CapturingReporter<typename Prop::Input> reporter;
+    const Result result = quickCheckReport(prop, reporter, 100, 0, 0,
+                                           DISABLE_SHRINK_TIMEOUT, 42);
+    REQUIRE(result.result == QC_FAILURE);
+    return reporter.counterexample;
+}
+
+}
+
+using namespace ShrinkTreeTestsFixtures;
+
+TEST_CASE("the children of an unfolded tree are the shrinks of its value",
+          "[shrink-tree]")
+{
+    const ShrinkTree<int> tree = unfoldShrinkTree(8, halve);
+    REQUIRE(tree.value() == 8);
+    const std::vector<ShrinkTree<int>> children = tree.children();
+    REQUIRE(children.size() == 1);
+    REQUIRE(children[0].value() == 4);
+    REQUIRE(children[0].children()[0].value() == 2);
+    REQUIRE(ShrinkTree<int>(3).children().empty());
+}
+
+TEST_CASE("mapped and filtered trees transform every node",
+          "[shrink-tree]")
+{
+    const ShrinkTree<std::string> mapped = mapShrinkTree<std::string>(
+        unfoldShrinkTree(8, halve), [](int x) { return std::to_string(x); });
+    REQUIRE(mapped.value() == "8");
+    REQUIRE(mapped.children()[0].children()[0].value() == "2");
+
+    // 6 -> 3 -> 1 -> 0, without the odd numbers
+    const ShrinkTree<int> filtered =
+        filterShrinkTree(unfoldShrinkTree(6, halve), isEven);
+    REQUIRE(filtered.value() == 6);
+    REQUIRE(filtered.children().empty());
+}
+
+TEST_CASE("convert shrinks values that are not equality comparable",
+          "[shrink-tree]")
+{
+    const Box b = std::get<0>(shrunkCounterexample(BoxBelow10()));
+    REQUIRE(b.x == 10);
+}
+
+TEST_CASE("combine shrinks both of its arguments", "[shrink-tree]")
+{
+    const Point p = std::get<0>(shrunkCounterexample(PointNearOrigin()));
+    const int sum = p.x + p.y;
+    REQUIRE(sum == 10);
+}
+
+TEST_CASE("suchThat only shrinks to values satisfying the predicate",
+          "[shrink-tree]")
+{
+    const int x = std::get<0>(shrunkCounterexample(EvenBelow101()));
+    REQUIRE(x == 102);
+}
+
+TEST_CASE("sampleShrink lists the shrinks of converted values",
+          "[shrink-tree]")
+{
+    const Generator<std::string> gen = convert<std::string, int>(
+        [](int x) { return std::to_string(x); }, choose(0, 8));
+    for (const auto &sample : sampleShrink(gen, 10, 1)) {
+        // choose shrinks to every smaller value in its range
+        const std::size_t numShrinks = std::stoi(sample.first);
+        REQUIRE(sample.second.size() == numShrinks);
+        if (numShrinks != 0)
+            REQUIRE(sample.second[0] == "0");
+    }
+}
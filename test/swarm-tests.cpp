@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "catch.hpp"
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+
+using namespace cppqc;
+
+namespace SwarmTestsFixtures {
+
+// Sets swarmTesting for the lifetime of the object.
+struct ScopedSwarm
+{
+    explicit ScopedSwarm(bool swarm) : previous(swarmTesting())
+    {
+        swarmTesting() = swarm;
+    }
+
+    ~ScopedSwarm()
+    {
+        swarmTesting() = previous;
+    }
+
+    const bool previous;
+};
+
+// Calls a stateful generator for every element, unlike listOf; for
+// instance to generate a sequence of commands.
+struct SequenceOf
+{
+    explicit SequenceOf(const Generator<int> &g) : gen(g) {}
+
+    std::vector<int> unGen(RngEngine &rng, std::size_t size)
+    {
+        std::vector<int> ret(detail::uniformInt<std::size_t>(rng, 0, size));
+        for (int &x : ret)
+            x = gen.unGen(rng, size);
+        return ret;
+    }
+
+    std::vector<std::vector<int>> shrink(const std::vector<int> &)
+    {
+        return std::vector<std::vector<int>>();
+    }
+
+    Generator<int> gen;
+};
+
+Generator<int> digits()
+{
+    return oneof<int>(choose(0, 0))(choose(1, 1))(choose(2, 2))
+        (choose(3, 3));
+}
+
+// Builds a new digits generator for every digit.
+Generator<int> sizedDigits()
+{
+    return sized<int>([](std::size_t) { return digits(); });
+}
+
+// The number of test cases whose list misses one of the digits.
+std::size_t numPartialMixes(const Generator<int> &element = digits())
+{
+    Generator<std::vector<int>> gen = SequenceOf(element);
+    std::size_t numPartial = 0;
+    for (RngEngine::result_type seed = 0; seed < 100; ++seed) {
+        RngEngine rng(seed);
+        const std::vector<int> v = gen.unGen(rng, 100);
+        const std::set<int> seen(v.begin(), v.end());
+        if (v.size() >= 40 && seen.size() < 4)
+            ++numPartial;
+    }
+    return numPartial;
+}
+
+// Fails on many instances of a rare branch.
+struct FewRareElements : Property<std::vector<int>>
+{
+    FewRareElements() :
+        Property(SequenceOf(frequency<int>(9, choose(0, 0))
+                                          (1, choose(1, 1))))
+    {
+    }
+
+    bool check(const std::vector<int> &v) const override
+    {
+        return std::count(v.begin(), v.end(), 1) < 25;
+    }
+};
+
+} // end SwarmTestsFixtures
+
+using namespace SwarmTestsFixtures;
+
+TEST_CASE("swarm testing uses a subset of the branches per test case",
+          "[swarm]")
+{
+    {
+        ScopedSwarm swarm(false);
+        REQUIRE(numPartialMixes() == 0);
+    }
+    ScopedSwarm swarm(true);
+    REQUIRE(numPartialMixes() > 50);
+}
+
+TEST_CASE("swarm testing keeps the subset of generators built per value",
+          "[swarm]")
+{
+    {
+        ScopedSwarm swarm(false);
+        REQUIRE(numPartialMixes(sizedDigits()) == 0);
+    }
+    ScopedSwarm swarm(true);
+    REQUIRE(numPartialMixes(sizedDigits()) > 50);
+}
+
+TEST_CASE("swarm testing finds inputs with many instances of a rare branch",
+          "[swarm]")
+{
+    {
+        ScopedSwarm swarm(false);
+        std::ostringstream out;
+        REQUIRE(quickCheckOutput(FewRareElements(), out, 100, 0, 0,
+                                 DISABLE_SHRINK_TIMEOUT, 42).result ==
+                QC_SUCCESS);
+    }
+    ScopedSwarm swarm(true);
+    std::ostringstream out;
+    const Result result = quickCheckOutput(FewRareElements(), out, 100, 0,
+                                           0, DISABLE_SHRINK_TIMEOUT, 42);
+    REQUIRE(result.result == QC_FAILURE);
+    REQUIRE(result.numTests < 100);
+}
+
+TEST_CASE("swarm testing is determined by the seed", "[swarm]")
+{
+    ScopedSwarm swarm(true);
+    std::ostringstream out1, out2;
+    const Result run1 = quickCheckOutput(FewRareElements(), out1, 100, 0, 0,
+                                         DISABLE_SHRINK_TIMEOUT, 7);
+    const Result run2 = quickCheckOutput(FewRareElements(), out2, 100, 0, 0,
+                                         DISABLE_SHRINK_TIMEOUT, 7);
+    REQUIRE(run1.numTests == run2.numTests);
+    REQUIRE(out1.str() == out2.str());
+
+    // replaying the failing test case uses the same branches
+    REQUIRE(run1.result == QC_FAILURE);
+    RngEngine rng = detail::testCaseRng(run1.failedTestCase);
+    const std::vector<int> v = std::get<0>(
+        FewRareElements().generateInput(rng, run1.usedSize));
+    REQUIRE(!FewRareElements().checkInput(std::make_tuple(v)));
+}
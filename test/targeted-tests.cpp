@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc.h"
+#include "cppqc/Targeted.h"
+#include "catch.hpp"
+
+#include <sstream>
+
+using namespace cppqc;
+
+namespace TargetedTestsFixtures {
+
+// Positive elements are pushed onto a queue, negative ones pop an element
+// if there is one. The queue overflows at a depth that random lists of
+// numbers almost never reach.
+std::size_t maxQueueDepth(const std::vector<int> &ops)
+{
+    std::size_t depth = 0, maxDepth = 0;
+    for (int op : ops) {
+        if (op > 0)
+            maxDepth = std::max(maxDepth, ++depth);
+        else if (op < 0 && depth > 0)
+            --depth;
+    }
+    return maxDepth;
+}
+
+struct QueueNeverOverflows : TargetedProperty<std::vector<int>>
+{
+    bool check(const std::vector<int> &ops) const override
+    {
+        if (maxQueueDepth(ops) < 40)
+            return true;
+        lastFailure = ops;
+        return false;
+    }
+
+    double utility(const std::vector<int> &ops) const override
+    {
+        return double(maxQueueDepth(ops));
+    }
+
+    mutable std::vector<int> lastFailure;
+};
+
+struct QueueStaysShort : TargetedProperty<std::vector<int>>
+{
+    bool check(const std::vector<int> &ops) const override
+    {
+        return maxQueueDepth(ops) <= 100;
+    }
+
+    double utility(const std::vector<int> &ops) const override
+    {
+        return double(maxQueueDepth(ops));
+    }
+};
+
+} // end TargetedTestsFixtures
+
+TEST_CASE("targeted search finds a rare overflow that random testing misses",
+          "[targeted]")
+{
+    TargetedTestsFixtures::QueueNeverOverflows prop;
+    std::ostringstream random;
+    const Result randomRun = quickCheckOutput(prop, random, 2000, 0, 0,
+                                              DISABLE_SHRINK_TIMEOUT, 42);
+    REQUIRE(randomRun.result == QC_SUCCESS);
+
+    for (TargetedSearch search : {HILL_CLIMBING, SIMULATED_ANNEALING}) {
+        std::ostringstream out;
+        const TargetedResult result = quickCheckTargeted(prop, out, 2000, 0,
+            0, DISABLE_SHRINK_TIMEOUT, 42, search);
+        REQUIRE(result.result == QC_FAILURE);
+        REQUIRE(result.numTests < 2000);
+        REQUIRE(result.seed == 42);
+        // the input came from the search, not from a replayable test case
+        REQUIRE(out.str().find(CPPQUICKCHECK_REPLAY_ENV) ==
+                std::string::npos);
+        REQUIRE(out.str().find(CPPQUICKCHECK_SEED_ENV + std::string("=42")) !=
+                std::string::npos);
+        // the counterexample is shrunk as usual
+        REQUIRE(prop.lastFailure == std::vector<int>(40, 1));
+    }
+}
+
+TEST_CASE("a passing targeted run reports the highest utility",
+          "[targeted]")
+{
+    const TargetedTestsFixtures::QueueStaysShort prop;
+    std::ostringstream out1, out2;
+    const TargetedResult run1 = quickCheckTargeted(prop, out1, 200, 0, 0,
+        DISABLE_SHRINK_TIMEOUT, 7);
+    REQUIRE(run1.result == QC_SUCCESS);
+    REQUIRE(run1.numTests == 200);
+    REQUIRE(run1.maxUtility > 0);
+    REQUIRE(out1.str().find("highest utility") != std::string::npos);
+
+    // the seed reproduces the search
+    const TargetedResult run2 = quickCheckTargeted(prop, out2, 200, 0, 0,
+        DISABLE_SHRINK_TIMEOUT, 7);
+    REQUIRE(run2.maxUtility == run1.maxUtility);
+    REQUIRE(out1.str() == out2.str());
+}
+
+TEST_CASE("targeted runs report through any reporter", "[targeted]")
+{
+    const TargetedTestsFixtures::QueueStaysShort prop;
+    std::ostringstream out;
+    const TargetedResult streamed = quickCheckTargeted(prop, out, 200, 0, 0,
+        DISABLE_SHRINK_TIMEOUT, 7);
+    NullReporter reporter;
+    const TargetedResult silent = quickCheckTargetedReport(prop, reporter,
+        200, 0, 0, DISABLE_SHRINK_TIMEOUT, 7);
+    REQUIRE(silent.result == QC_SUCCESS);
+    REQUIRE(silent.maxUtility == streamed.maxUtility);
+    REQUIRE(out.str().find("+++ OK, passed 200 tests") != std::string::npos);
+}
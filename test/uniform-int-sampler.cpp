@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2016, Philipp Classen All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *   * Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above copyright notice,
+ *     this list of conditions and the following disclaimer in the documentation
+ *     and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDERS OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cppqc/Generator.h"
+#include "catch.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace cppqc;
+
+template <typename Integer>
+void checkSamplerStaysInRange(Integer min, Integer max)
+{
+    const detail::UniformIntSampler<Integer> sampler(min, max);
+    REQUIRE(sampler.min() == min);
+    REQUIRE(sampler.max() == max);
+
+    RngEngine rng(1234);
+    for (int i = 0; i < 10000; i++) {
+        const Integer x = sampler(rng);
+        REQUIRE(x >= min);
+        REQUIRE(x <= max);
+    }
+}
+
+TEST_CASE("bounded sampler stays within its range",
+          "[sampler]")
+{
+    checkSamplerStaysInRange<int>(0, 0);
+    checkSamplerStaysInRange<int>(-5, 5);
+    checkSamplerStaysInRange<char>(0x20, 0x7f);
+    checkSamplerStaysInRange<unsigned char>(0, 255);
+    checkSamplerStaysInRange<std::uint32_t>(0, 0xffffffffu);
+    checkSamplerStaysInRange<std::int64_t>(-(std::int64_t(1) << 40),
+                                           std::int64_t(1) << 40);
+    checkSamplerStaysInRange<std::int64_t>(
+        std::numeric_limits<std::int64_t>::min(),
+        std::numeric_limits<std::int64_t>::max());
+}
+
+TEST_CASE("bounded sampler hits every value of a small range about equally",
+          "[sampler]")
+{
+    const int N = 7;
+    const int DRAWS = 70000;
+    constexpr detail::UniformIntSampler<int> sampler(10, 10 + N - 1);
+
+    std::vector<int> histogram(N, 0);
+    RngEngine rng(42);
+    for (int i = 0; i < DRAWS; i++)
+        ++histogram[sampler(rng) - 10];
+
+    for (int count : histogram) {
+        REQUIRE(count > DRAWS / N * 9 / 10);
+        REQUIRE(count < DRAWS / N * 11 / 10);
+    }
+}